@@ -0,0 +1,212 @@
+#include "Bitboard.h"
+
+// конструктор по умолчанию
+Bitboard::Bitboard() : Bitboard(0) {}
+
+// конструктор с количеством битов
+Bitboard::Bitboard(int bits) {
+    allocate(bits);
+    clear();
+}
+
+// конструктор перемещения
+Bitboard::Bitboard(Bitboard&& other) noexcept 
+    : bitCount(other.bitCount), wordCount(other.wordCount), words(inlineWords) {
+    if (other.isInline()) {
+        std::memcpy(inlineWords, other.inlineWords, sizeof(inlineWords));
+    } else {
+        if (other.words) {
+            words = other.words;
+        } else {
+            words = nullptr;
+            chunks = std::move(other.chunks);
+        }
+        other.words = other.inlineWords;
+        other.bitCount = 0;
+        other.wordCount = 0;
+    }
+}
+
+// оператор перемещения
+Bitboard& Bitboard::operator=(Bitboard&& other) noexcept {
+    if (this != &other) {
+        if (!other.isInline()) {
+            release();
+            bitCount = other.bitCount;
+            wordCount = other.wordCount;
+            words = other.words;
+            chunks = std::move(other.chunks);
+            other.words = other.inlineWords;
+            other.bitCount = 0;
+            other.wordCount = 0;
+        } else {
+            *this = static_cast<const Bitboard&>(other);
+        }
+    }
+    return *this;
+}
+
+size_t Bitboard::memoryUsage() const {
+    if (words) {
+        return isInline() ? 0 : sizeof(uint64_t) * wordCount;
+    }
+    // куски плюс примерные накладные расходы узла и корзины хеш-таблицы
+    return chunks->size() * (sizeof(Chunk) + 4 * sizeof(void*)) + 
+           chunks->bucket_count() * sizeof(void*);
+}
+
+uint64_t Bitboard::sparseWord(int i) const {
+    auto it = chunks->find(i / CHUNK_WORDS);
+    return it == chunks->end() ? 0 : it->second[i % CHUNK_WORDS];
+}
+
+void Bitboard::setSparseWord(int i, uint64_t value) {
+    int chunk = i / CHUNK_WORDS;
+    auto it = chunks->find(chunk);
+    if (it == chunks->end()) {
+        if (!value) return;
+        it = chunks->emplace(chunk, Chunk()).first;
+        it->second.fill(0);
+    }
+    it->second[i % CHUNK_WORDS] = value;
+    
+    // опустевший кусок освобождаем
+    if (!value) {
+        for (uint64_t word : it->second) {
+            if (word) return;
+        }
+        chunks->erase(it);
+    }
+}
+
+void Bitboard::sparseAnd(const Bitboard& other) {
+    for (auto it = chunks->begin(); it != chunks->end(); ) {
+        bool empty = true;
+        for (int j = 0; j < CHUNK_WORDS; j++) {
+            it->second[j] &= other.getWord(it->first * CHUNK_WORDS + j);
+            if (it->second[j]) empty = false;
+        }
+        it = empty ? chunks->erase(it) : std::next(it);
+    }
+}
+
+void Bitboard::sparseOr(const Bitboard& other) {
+    if (other.words) {
+        for (int i = 0; i < wordCount; i++) {
+            if (other.words[i]) setSparseWord(i, sparseWord(i) | other.words[i]);
+        }
+        return;
+    }
+    for (const auto& entry : *other.chunks) {
+        for (int j = 0; j < CHUNK_WORDS; j++) {
+            int i = entry.first * CHUNK_WORDS + j;
+            if (entry.second[j]) setSparseWord(i, sparseWord(i) | entry.second[j]);
+        }
+    }
+}
+
+void Bitboard::sparseAndNot(const Bitboard& other) {
+    for (auto it = chunks->begin(); it != chunks->end(); ) {
+        bool empty = true;
+        for (int j = 0; j < CHUNK_WORDS; j++) {
+            it->second[j] &= ~other.getWord(it->first * CHUNK_WORDS + j);
+            if (it->second[j]) empty = false;
+        }
+        it = empty ? chunks->erase(it) : std::next(it);
+    }
+}
+
+void Bitboard::sparseShift(int n, bool up) {
+    // сдвигаем по установленным битам: стоимость по их числу, а не по площади
+    ChunkMap shifted;
+    std::swap(shifted, *chunks);
+    for (const auto& entry : shifted) {
+        for (int j = 0; j < CHUNK_WORDS; j++) {
+            uint64_t word = entry.second[j];
+            int base = (entry.first * CHUNK_WORDS + j) << 6;
+            while (word) {
+                long long target = static_cast<long long>(base + __builtin_ctzll(word)) + (up ? n : -n);
+                if (target >= 0 && target < bitCount) set(static_cast<int>(target));
+                word &= word - 1;
+            }
+        }
+    }
+}
+
+bool Bitboard::any() const {
+    if (!words) {
+        // пустые куски не хранятся
+        return !chunks->empty();
+    }
+    const uint64_t* words = data();
+    for (int i = 0; i < wordCount; i++) {
+        if (words[i]) return true;
+    }
+    return false;
+}
+
+int Bitboard::select(int k) const {
+    int result = -1;
+    if (!words) {
+        forEachSetBit([&](int index) {
+            if (k-- == 0) result = index;
+        });
+        return result;
+    }
+    const uint64_t* words = data();
+    for (int i = 0; i < wordCount; i++) {
+        int bits = __builtin_popcountll(words[i]);
+        if (k < bits) {
+            return (i << 6) + selectInWord(words[i], k);
+        }
+        k -= bits;
+    }
+    return -1;
+}
+
+int Bitboard::selectInWord(uint64_t word, int k) {
+    // число битов в каждом байте параллельно, затем нарастающие суммы по байтам умножением
+    const uint64_t ONES = 0x0101010101010101ULL;
+    const uint64_t HIGHS = 0x8080808080808080ULL;
+    uint64_t bytes = word - ((word >> 1) & 0x5555555555555555ULL);
+    bytes = (bytes & 0x3333333333333333ULL) + ((bytes >> 2) & 0x3333333333333333ULL);
+    bytes = (bytes + (bytes >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    uint64_t prefix = bytes * ONES;
+    
+    // нужный байт - первый, где нарастающая сумма больше k; суммы не больше 64, старший бит свободен
+    uint64_t notAbove = ((static_cast<uint64_t>(k) * ONES | HIGHS) - prefix) & HIGHS;
+    int byte = __builtin_ctzll(~notAbove & HIGHS) >> 3;
+    int offset = byte << 3;
+    if (byte > 0) k -= static_cast<int>((prefix >> (offset - 8)) & 0xFF);
+    
+    word >>= offset;
+    for (; k > 0; k--) {
+        word &= word - 1;
+    }
+    return offset + __builtin_ctzll(word);
+}
+
+Bitboard Bitboard::operator~() const {
+    Bitboard result(*this);
+    for (int i = 0; i < wordCount; i++) {
+        result.setWord(i, ~getWord(i));
+    }
+    if (wordCount > 0 && (bitCount & 63)) {
+        result.setWord(wordCount - 1, result.getWord(wordCount - 1) & lowMask(bitCount & 63));
+    }
+    return result;
+}
+
+bool Bitboard::operator==(const Bitboard& other) const {
+    if (bitCount != other.bitCount) return false;
+    if (!words) {
+        // пустые куски не хранятся, поэтому достаточно сравнить таблицы
+        return *chunks == *other.chunks;
+    }
+    const uint64_t* words = data();
+    const uint64_t* otherWords = other.data();
+    for (int i = 0; i < wordCount; i++) {
+        if (words[i] != otherWords[i]) return false;
+    }
+    return true;
+}
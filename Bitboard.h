@@ -0,0 +1,403 @@
+#ifndef BITBOARD_H
+#define BITBOARD_H
+
+#include <cstdint>
+#include <cstring>
+#include <array>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include <algorithm>
+
+// битовая доска: по одному биту на клетку, индекс клетки = y * size + x
+// поля до 16x16 целиком помещаются во встроенный буфер без выделения памяти,
+// очень большие доски хранятся разреженно - кусками по CHUNK_WORDS слов,
+// память выделяется только под куски с установленными битами
+class Bitboard {
+public:
+    static const int SPARSE_MIN_BITS = 1 << 19;  // с этого размера доска разреженная
+    static const int CHUNK_WORDS = 8;
+
+private:
+    static const int INLINE_WORDS = 4;
+
+    typedef std::array<uint64_t, CHUNK_WORDS> Chunk;
+    typedef std::unordered_map<int, Chunk> ChunkMap;
+
+    int bitCount;
+    int wordCount;
+    uint64_t* words;  // inlineWords или буфер в куче для больших полей; nullptr у разреженной
+    uint64_t inlineWords[INLINE_WORDS];
+    std::unique_ptr<ChunkMap> chunks;  // куски разреженной доски по номеру
+
+    uint64_t* data() { return words; }
+    const uint64_t* data() const { return words; }
+    bool isInline() const { return words == inlineWords; }
+    void allocate(int bits);
+    void release();
+
+    // разреженное хранение: доступ к слову и поразрядные операции по кускам
+    uint64_t sparseWord(int i) const;
+    void setSparseWord(int i, uint64_t value);
+    void sparseAnd(const Bitboard& other);
+    void sparseOr(const Bitboard& other);
+    void sparseAndNot(const Bitboard& other);
+    void sparseShift(int n, bool up);
+    template<typename F>
+    void forEachChunkInOrder(F f) const;
+
+    static uint64_t lowMask(int len) { return len >= 64 ? ~0ULL : ((1ULL << len) - 1); }
+
+public:
+    // конструкторы
+    Bitboard();
+    explicit Bitboard(int bits);
+
+    Bitboard(const Bitboard& other);
+    Bitboard(Bitboard&& other) noexcept;
+
+    Bitboard& operator=(const Bitboard& other);
+    Bitboard& operator=(Bitboard&& other) noexcept;
+
+    ~Bitboard();
+
+    int size() const { return bitCount; }
+    bool isSparse() const { return words == nullptr; }
+
+    // память под биты доски в байтах
+    size_t memoryUsage() const;
+
+    // доступ к 64-битным словам для поразрядных ядер
+    // (у разреженной доски работает, но обход всех слов стоит O(площади))
+    int getWordCount() const { return wordCount; }
+    uint64_t getWord(int i) const { return words ? words[i] : sparseWord(i); }
+    void setWord(int i, uint64_t value);
+
+    // слово i доски, сдвинутой на n битов к старшим/младшим разрядам, без копирования доски
+    uint64_t getWordShiftedUp(int i, int n) const;
+    uint64_t getWordShiftedDown(int i, int n) const;
+
+    // операции над отдельными битами
+    bool test(int i) const { return (getWord(i >> 6) >> (i & 63)) & 1ULL; }
+    void set(int i);
+    void reset(int i);
+
+    // операции над отрезком из len <= 64 подряд идущих битов
+    uint64_t getRange(int begin, int len) const;
+    void orRange(int begin, int len, uint64_t bits);
+    void andNotRange(int begin, int len, uint64_t bits);
+    bool anyInRange(int begin, int len) const { return getRange(begin, len) != 0; }
+    void setRange(int begin, int len) { orRange(begin, len, lowMask(len)); }
+    void resetRange(int begin, int len) { andNotRange(begin, len, lowMask(len)); }
+
+    // операции над всей доской
+    void clear();
+    bool any() const;
+    int count() const;
+
+    // позиция k-го (с нуля) установленного бита, -1 если битов меньше
+    int select(int k) const;
+    // то же в одном слове; k меньше числа битов word
+    static int selectInWord(uint64_t word, int k);
+
+    // поразрядные операции над досками одного размера
+    // (сдвиги и дополнение разреженной доски стоят O(площади))
+    Bitboard& operator&=(const Bitboard& other);
+    Bitboard& operator|=(const Bitboard& other);
+    Bitboard& andNot(const Bitboard& other);
+    Bitboard& operator<<=(int n);
+    Bitboard& operator>>=(int n);
+    Bitboard operator~() const;
+    bool operator==(const Bitboard& other) const;
+    bool operator!=(const Bitboard& other) const { return !(*this == other); }
+
+    // вызывает f(индекс) для каждого установленного бита по возрастанию
+    template<typename F>
+    void forEachSetBit(F f) const;
+};
+
+inline Bitboard operator&(Bitboard a, const Bitboard& b) { return a &= b; }
+inline Bitboard operator|(Bitboard a, const Bitboard& b) { return a |= b; }
+inline Bitboard operator<<(Bitboard a, int n) { return a <<= n; }
+inline Bitboard operator>>(Bitboard a, int n) { return a >>= n; }
+
+inline int Bitboard::count() const {
+    int total = 0;
+    if (!words) {
+        for (const auto& entry : *chunks) {
+            for (uint64_t word : entry.second) total += __builtin_popcountll(word);
+        }
+        return total;
+    }
+    for (int i = 0; i < wordCount; i++) {
+        total += __builtin_popcountll(words[i]);
+    }
+    return total;
+}
+
+inline Bitboard::Bitboard(const Bitboard& other) {
+    allocate(other.bitCount);
+    if (words) {
+        std::memcpy(words, other.words, sizeof(uint64_t) * wordCount);
+    } else {
+        *chunks = *other.chunks;
+    }
+}
+
+inline Bitboard::~Bitboard() {
+    release();
+}
+
+inline Bitboard& Bitboard::operator=(const Bitboard& other) {
+    if (this != &other) {
+        if (wordCount != other.wordCount) {
+            release();
+            allocate(other.bitCount);
+        }
+        bitCount = other.bitCount;
+        if (words) {
+            std::memcpy(words, other.words, sizeof(uint64_t) * wordCount);
+        } else {
+            *chunks = *other.chunks;
+        }
+    }
+    return *this;
+}
+
+inline void Bitboard::allocate(int bits) {
+    bitCount = bits;
+    wordCount = (bits + 63) / 64;
+    if (bits >= SPARSE_MIN_BITS) {
+        words = nullptr;
+        chunks.reset(new ChunkMap());
+    } else {
+        words = wordCount > INLINE_WORDS ? new uint64_t[wordCount] : inlineWords;
+    }
+}
+
+inline void Bitboard::release() {
+    if (!words) {
+        chunks.reset();
+        words = inlineWords;
+    } else if (!isInline()) {
+        delete[] words;
+        words = inlineWords;
+    }
+}
+
+inline void Bitboard::setWord(int i, uint64_t value) {
+    if (words) {
+        words[i] = value;
+    } else {
+        setSparseWord(i, value);
+    }
+}
+
+inline void Bitboard::set(int i) {
+    if (words) {
+        words[i >> 6] |= 1ULL << (i & 63);
+    } else {
+        setSparseWord(i >> 6, sparseWord(i >> 6) | (1ULL << (i & 63)));
+    }
+}
+
+inline void Bitboard::reset(int i) {
+    if (words) {
+        words[i >> 6] &= ~(1ULL << (i & 63));
+    } else {
+        setSparseWord(i >> 6, sparseWord(i >> 6) & ~(1ULL << (i & 63)));
+    }
+}
+
+inline void Bitboard::clear() {
+    if (words) {
+        std::memset(words, 0, sizeof(uint64_t) * wordCount);
+    } else {
+        chunks->clear();
+    }
+}
+
+inline uint64_t Bitboard::getWordShiftedUp(int i, int n) const {
+    int from = i - (n >> 6);
+    int shift = n & 63;
+    if (from < 0) return 0;
+    uint64_t value = getWord(from) << shift;
+    if (shift && from > 0) value |= getWord(from - 1) >> (64 - shift);
+    return value;
+}
+
+inline uint64_t Bitboard::getWordShiftedDown(int i, int n) const {
+    int from = i + (n >> 6);
+    int shift = n & 63;
+    if (from >= wordCount) return 0;
+    uint64_t value = getWord(from) >> shift;
+    if (shift && from + 1 < wordCount) value |= getWord(from + 1) << (64 - shift);
+    return value;
+}
+
+inline uint64_t Bitboard::getRange(int begin, int len) const {
+    int word = begin >> 6;
+    int shift = begin & 63;
+    uint64_t bits = getWord(word) >> shift;
+    if (shift + len > 64) {
+        bits |= getWord(word + 1) << (64 - shift);
+    }
+    return bits & lowMask(len);
+}
+
+inline void Bitboard::orRange(int begin, int len, uint64_t bits) {
+    bits &= lowMask(len);
+    int word = begin >> 6;
+    int shift = begin & 63;
+    if (words) {
+        words[word] |= bits << shift;
+        if (shift + len > 64) {
+            words[word + 1] |= bits >> (64 - shift);
+        }
+        return;
+    }
+    if (bits << shift) setSparseWord(word, sparseWord(word) | (bits << shift));
+    if (shift + len > 64 && (bits >> (64 - shift))) {
+        setSparseWord(word + 1, sparseWord(word + 1) | (bits >> (64 - shift)));
+    }
+}
+
+inline void Bitboard::andNotRange(int begin, int len, uint64_t bits) {
+    bits &= lowMask(len);
+    int word = begin >> 6;
+    int shift = begin & 63;
+    if (words) {
+        words[word] &= ~(bits << shift);
+        if (shift + len > 64) {
+            words[word + 1] &= ~(bits >> (64 - shift));
+        }
+        return;
+    }
+    if (bits << shift) setSparseWord(word, sparseWord(word) & ~(bits << shift));
+    if (shift + len > 64 && (bits >> (64 - shift))) {
+        setSparseWord(word + 1, sparseWord(word + 1) & ~(bits >> (64 - shift)));
+    }
+}
+
+inline Bitboard& Bitboard::operator&=(const Bitboard& other) {
+    if (!words) {
+        sparseAnd(other);
+        return *this;
+    }
+    uint64_t* words = data();
+    const uint64_t* otherWords = other.data();
+    for (int i = 0; i < wordCount; i++) {
+        words[i] &= otherWords[i];
+    }
+    return *this;
+}
+
+inline Bitboard& Bitboard::operator|=(const Bitboard& other) {
+    if (!words) {
+        sparseOr(other);
+        return *this;
+    }
+    uint64_t* words = data();
+    const uint64_t* otherWords = other.data();
+    for (int i = 0; i < wordCount; i++) {
+        words[i] |= otherWords[i];
+    }
+    return *this;
+}
+
+inline Bitboard& Bitboard::andNot(const Bitboard& other) {
+    if (!words) {
+        sparseAndNot(other);
+        return *this;
+    }
+    uint64_t* words = data();
+    const uint64_t* otherWords = other.data();
+    for (int i = 0; i < wordCount; i++) {
+        words[i] &= ~otherWords[i];
+    }
+    return *this;
+}
+
+inline Bitboard& Bitboard::operator<<=(int n) {
+    if (!words) {
+        sparseShift(n, true);
+        return *this;
+    }
+    uint64_t* words = data();
+    int wordShift = n >> 6;
+    int bitShift = n & 63;
+    for (int i = wordCount - 1; i >= 0; i--) {
+        int from = i - wordShift;
+        uint64_t value = 0;
+        if (from >= 0) {
+            value = words[from] << bitShift;
+            if (bitShift && from > 0) value |= words[from - 1] >> (64 - bitShift);
+        }
+        words[i] = value;
+    }
+    // биты за пределами доски всегда нулевые
+    if (wordCount > 0 && (bitCount & 63)) {
+        words[wordCount - 1] &= lowMask(bitCount & 63);
+    }
+    return *this;
+}
+
+inline Bitboard& Bitboard::operator>>=(int n) {
+    if (!words) {
+        sparseShift(n, false);
+        return *this;
+    }
+    uint64_t* words = data();
+    int wordShift = n >> 6;
+    int bitShift = n & 63;
+    for (int i = 0; i < wordCount; i++) {
+        int from = i + wordShift;
+        uint64_t value = 0;
+        if (from < wordCount) {
+            value = words[from] >> bitShift;
+            if (bitShift && from + 1 < wordCount) value |= words[from + 1] << (64 - bitShift);
+        }
+        words[i] = value;
+    }
+    return *this;
+}
+
+template<typename F>
+void Bitboard::forEachChunkInOrder(F f) const {
+    std::vector<int> order;
+    order.reserve(chunks->size());
+    for (const auto& entry : *chunks) {
+        order.push_back(entry.first);
+    }
+    std::sort(order.begin(), order.end());
+    for (int chunk : order) {
+        f(chunk, chunks->find(chunk)->second);
+    }
+}
+
+template<typename F>
+void Bitboard::forEachSetBit(F f) const {
+    if (!words) {
+        forEachChunkInOrder([&](int chunk, const Chunk& chunkWords) {
+            for (int j = 0; j < CHUNK_WORDS; j++) {
+                uint64_t word = chunkWords[j];
+                int base = (chunk * CHUNK_WORDS + j) << 6;
+                while (word) {
+                    f(base + __builtin_ctzll(word));
+                    word &= word - 1;
+                }
+            }
+        });
+        return;
+    }
+    const uint64_t* words = data();
+    for (int i = 0; i < wordCount; i++) {
+        uint64_t word = words[i];
+        while (word) {
+            f((i << 6) + __builtin_ctzll(word));
+            word &= word - 1;
+        }
+    }
+}
+
+#endif
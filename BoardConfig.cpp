@@ -0,0 +1,76 @@
+#include "BoardConfig.h"
+#include "FleetGenerator.h"
+#include <algorithm>
+#include <sstream>
+
+BoardConfig::BoardConfig() : BoardConfig(standard()) {}
+
+BoardConfig::BoardConfig(int size, const std::vector<int>& fleet) : size(size), fleet(fleet) {}
+
+int BoardConfig::shipCount(int length) const {
+    return static_cast<int>(std::count(fleet.begin(), fleet.end(), length));
+}
+
+int BoardConfig::maxShipLength() const {
+    return fleet.empty() ? 0 : *std::max_element(fleet.begin(), fleet.end());
+}
+
+int BoardConfig::fleetCells() const {
+    int cells = 0;
+    for (int length : fleet) cells += length;
+    return cells;
+}
+
+bool BoardConfig::isValid() const {
+    // индекс клетки y * size + x должен помещаться в int
+    if (size < 1 || size > 46340 || fleet.empty()) return false;
+    for (int length : fleet) {
+        if (length < 1 || length > size) return false;
+    }
+    return true;
+}
+
+std::string BoardConfig::shipName(int length) {
+    switch (length) {
+        case 4: return "Линкор";
+        case 3: return "Крейсер";
+        case 2: return "Эсминец";
+        case 1: return "Катер";
+        default: return "Корабль";
+    }
+}
+
+BoardConfig BoardConfig::standard() {
+    BoardConfig config(10, FleetGenerator::standardFleet());
+    return config;
+}
+
+bool BoardConfig::parseFleet(const std::string& text, std::vector<int>& fleet) {
+    std::vector<int> parsed;
+    std::stringstream stream(text);
+    std::string item;
+    
+    while (std::getline(stream, item, ',')) {
+        size_t separator = item.find('x');
+        try {
+            // длина должна занимать всё до 'x' (или всю запись), число - всё после
+            size_t lengthEnd = separator == std::string::npos ? item.size() : separator;
+            size_t used = 0;
+            int length = std::stoi(item.substr(0, lengthEnd), &used);
+            if (used != lengthEnd) return false;
+            int count = 1;
+            if (separator != std::string::npos) {
+                count = std::stoi(item.substr(separator + 1), &used);
+                if (used != item.size() - separator - 1) return false;
+            }
+            if (length < 1 || count < 1) return false;
+            parsed.insert(parsed.end(), count, length);
+        } catch (...) {
+            return false;
+        }
+    }
+    
+    if (parsed.empty()) return false;
+    fleet = parsed;
+    return true;
+}
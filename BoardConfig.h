@@ -0,0 +1,33 @@
+#ifndef BOARD_CONFIG_H
+#define BOARD_CONFIG_H
+
+#include <string>
+#include <vector>
+
+// размер поля и состав флота партии
+struct BoardConfig {
+    int size;
+    std::vector<int> fleet;  // длины кораблей
+    
+    BoardConfig();
+    BoardConfig(int size, const std::vector<int>& fleet);
+    
+    // сколько в флоте кораблей длины length
+    int shipCount(int length) const;
+    int maxShipLength() const;
+    int fleetCells() const;
+    
+    // размер и флот, с которыми партию можно сыграть
+    bool isValid() const;
+    
+    // название корабля по длине: линкор, крейсер, эсминец, катер
+    static std::string shipName(int length);
+    
+    // флот по умолчанию на поле 10x10: 1x4, 2x3, 3x2, 4x1
+    static BoardConfig standard();
+    
+    // разбор флота вида "4,3,3,2" или "4x1,3x2,2x3,1x4" (длина x количество)
+    static bool parseFleet(const std::string& text, std::vector<int>& fleet);
+};
+
+#endif
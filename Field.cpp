@@ -1,128 +1,224 @@
 #include "Field.h"
+#include "FleetGenerator.h"
+#include "Random.h"
 #include <iostream>
 #include <iomanip>
-#include <random>
 #include <algorithm>
 
-// конструктор по умолчанию
-Field::Field() : size(DEFAULT_FIELD_SIZE), destroyedShipsCount(0) {
-    cells.resize(size, std::vector<Cell>(size));
-    for (int y = 0; y < size; y++) {
-        for (int x = 0; x < size; x++) {
-            cells[y][x] = Cell(x, y);
+namespace {
+    uint64_t spanMask(int len) {
+        return len >= 64 ? ~0ULL : (1ULL << len) - 1;
+    }
+    
+    // xor ключей Зобриста для установленных битов bits отрезка, начинающегося с клетки begin
+    void toggleKeys(uint64_t& hash, int begin, uint64_t bits, Zobrist::Kind kind) {
+        while (bits) {
+            hash ^= Zobrist::key(begin + __builtin_ctzll(bits), kind);
+            bits &= bits - 1;
         }
     }
 }
 
-// конструктор с размером
-Field::Field(int size) : size(size), destroyedShipsCount(0) {
-    cells.resize(size, std::vector<Cell>(size));
-    for (int y = 0; y < size; y++) {
-        for (int x = 0; x < size; x++) {
-            cells[y][x] = Cell(x, y);
-        }
+// конструктор по умолчанию
+Field::Field() : Field(DEFAULT_FIELD_SIZE) {}
+
+// конструктор с размером и стандартным флотом
+Field::Field(int size) : Field(BoardConfig(size, FleetGenerator::standardFleet())) {}
+
+// Layout
+
+Field::Layout::Layout(int size, const std::vector<int>& fleet) 
+    : fleet(fleet), shipCells(size * size), blockedCells(size * size), 
+      emptyHash(Zobrist::boardKey(size, fleet)), hash(emptyHash) {
+    // плотный индекс кораблей только для плотного поля
+    if (!shipCells.isSparse()) {
+        shipIndexByCell.assign(size * size, -1);
     }
+    // флот хранится от длинных кораблей к коротким - в этом порядке их и расставляем
+    std::sort(this->fleet.begin(), this->fleet.end(), std::greater<int>());
+    ships.reserve(this->fleet.size());
 }
 
-// конструктор копирования
-Field::Field(const Field& other) 
-    : size(other.size), cells(other.cells), destroyedShipsCount(other.destroyedShipsCount) {
-    for (const auto& ship : other.ships) {
-        ships. push_back(std::make_unique<Ship>(*ship));
-    }
+void Field::Layout::clear() {
+    ships.clear();
+    std::fill(shipIndexByCell.begin(), shipIndexByCell.end(), -1);
+    sparseShipIndex.clear();
+    shipCells.clear();
+    blockedCells.clear();
+    hash = emptyHash;
 }
 
+// Field
+
+// конструктор с размером поля и составом флота
+Field::Field(const BoardConfig& config) 
+    : size(config.size), layout(std::make_shared<Layout>(config.size, config.fleet)), 
+      hitCells(size * size), missCells(size * size), destroyedCells(size * size), 
+      destroyedShipsCount(0), shotHash(0), rng(nullptr) {}
+
+// конструктор копирования: расстановка разделяется, выстрелы копируются
+Field::Field(const Field& other) 
+    : size(other.size), layout(other.layout), 
+      hitCells(other.hitCells), missCells(other.missCells), destroyedCells(other.destroyedCells),
+      shipHits(other.shipHits), destroyedShipsCount(other.destroyedShipsCount), shotHash(other.shotHash), rng(other.rng) {}
+
 // оператор присваивания
 Field& Field::operator=(const Field& other) {
     if (this != &other) {
         size = other.size;
-        cells = other.cells;
+        layout = other.layout;
+        hitCells = other.hitCells;
+        missCells = other.missCells;
+        destroyedCells = other.destroyedCells;
+        shipHits = other.shipHits;
         destroyedShipsCount = other. destroyedShipsCount;
-        ships. clear();
-        for (const auto& ship : other.ships) {
-            ships. push_back(std::make_unique<Ship>(*ship));
-        }
+        shotHash = other.shotHash;
+        undoJournal.clear();
     }
     return *this;
 }
 
+Field::Layout& Field::mutableLayout() {
+    // расстановку видит ещё кто-то - изменяем собственную копию
+    if (layout.use_count() > 1) {
+        layout = std::make_shared<Layout>(*layout);
+        layout->ships.reserve(layout->fleet.size());
+    }
+    return *layout;
+}
+
+Field::Snapshot Field::snapshot() const {
+    Snapshot result;
+    saveSnapshot(result);
+    return result;
+}
+
+void Field::saveSnapshot(Snapshot& snapshot) const {
+    snapshot.layout = layout;
+    snapshot.hitCells = hitCells;
+    snapshot.missCells = missCells;
+    snapshot.destroyedCells = destroyedCells;
+    snapshot.shipHits = shipHits;
+    snapshot.destroyedShipsCount = destroyedShipsCount;
+    snapshot.shotHash = shotHash;
+}
+
+void Field::restore(const Snapshot& snapshot) {
+    layout = snapshot.layout;
+    hitCells = snapshot.hitCells;
+    missCells = snapshot.missCells;
+    destroyedCells = snapshot.destroyedCells;
+    shipHits = snapshot.shipHits;
+    destroyedShipsCount = snapshot.destroyedShipsCount;
+    shotHash = snapshot.shotHash;
+    undoJournal.clear();
+}
+
 bool Field::isValidPosition(int x, int y) const {
     return x >= 0 && x < size && y >= 0 && y < size;
 }
 
+CellState Field::getCellState(int x, int y) const {
+    int index = cellIndex(x, y);
+    if (destroyedCells.test(index)) return CellState::Destroyed;
+    if (hitCells.test(index)) return CellState::Hit;
+    if (layout->shipCells.test(index)) return CellState::Ship;
+    if (missCells.test(index)) return CellState::Miss;
+    if (layout->blockedCells.test(index)) return CellState::Blocked;
+    return CellState::Empty;
+}
+
+int Field::getShipIndexAt(int x, int y) const {
+    int index = cellIndex(x, y);
+    if (!isSparse()) return layout->shipIndexByCell[index];
+    auto it = layout->sparseShipIndex.find(index);
+    return it == layout->sparseShipIndex.end() ? -1 : it->second;
+}
+
+// расстановка учитывается целиком, даже если её разделяют несколько копий
+size_t Field::memoryUsage() const {
+    size_t bytes = sizeof(Field) + sizeof(Layout) + layout->shipCells.memoryUsage() + 
+                   layout->blockedCells.memoryUsage() + 
+                   hitCells.memoryUsage() + missCells.memoryUsage() + destroyedCells.memoryUsage() + 
+                   shipHits.capacity() * sizeof(uint16_t);
+    bytes += layout->shipIndexByCell.capacity() * sizeof(int);
+    bytes += layout->sparseShipIndex.size() * (sizeof(std::pair<const int, int>) + 2 * sizeof(void*)) + 
+             layout->sparseShipIndex.bucket_count() * sizeof(void*);
+    bytes += layout->ships.capacity() * sizeof(ShipRecord);
+    return bytes;
+}
+
+Cell Field::getCell(int x, int y) const {
+    int shipIndex = getShipIndexAt(x, y);
+    // номер корабля в клетке - его индекс на поле
+    return Cell(x, y, getCellState(x, y), shipIndex);
+}
+
 bool Field::canPlaceShip(int x, int y, int shipSize, bool vertical) const {
     // проверяем, что корабль помещается на поле
+    if (! isValidPosition(x, y)) return false;
     if (vertical) {
         if (y + shipSize > size) return false;
     } else {
         if (x + shipSize > size) return false;
     }
     
-    // проверяем, что все клетки свободны
-    for (int i = 0; i < shipSize; i++) {
-        int checkX = vertical ? x : x + i;
-        int checkY = vertical ? y + i : y;
-        
-        if (! isValidPosition(checkX, checkY)) return false;
-        
-        const Cell& cell = cells[checkY][checkX];
-        if (cell.getState() != CellState::Empty && cell.getState() != CellState::Blocked) {
-            return false;
-        }
-        if (cell.getState() == CellState::Blocked) {
-            return false;
+    // проверяем, что все клетки свободны и не соседствуют с другими кораблями
+    bool free = true;
+    forEachDeckSpan(x, y, shipSize, vertical, [&](int begin, int len) {
+        if (layout->shipCells.anyInRange(begin, len) || layout->blockedCells.anyInRange(begin, len) ||
+            missCells.anyInRange(begin, len)) {
+            free = false;
         }
-    }
+    });
     
-    return true;
+    return free;
 }
 
-void Field::markSurroundingCells(const Ship& ship) {
-    auto coords = ship.getDecksCoordinates();
+void Field::occupyCells(const ShipRecord& ship, int shipIndex) {
+    Layout& target = mutableLayout();
+    forEachDeckSpan(ship.x, ship.y, ship.size, ship.vertical, 
+                    [&](int begin, int len) { target.shipCells.setRange(begin, len); });
     
-    for (const auto& coord : coords) {
-        // проверяем все 8 соседних клеток
-        for (int dy = -1; dy <= 1; dy++) {
-            for (int dx = -1; dx <= 1; dx++) {
-                int nx = coord.first + dx;
-                int ny = coord.second + dy;
-                
-                if (isValidPosition(nx, ny)) {
-                    Cell& cell = cells[ny][nx];
-                    if (cell.getState() == CellState::Empty) {
-                        cell.setState(CellState::Blocked);
-                    }
-                }
-            }
+    for (std::pair<int, int> deck : ship.getDecksCoordinates()) {
+        int cell = cellIndex(deck.first, deck.second);
+        target.hash ^= Zobrist::key(cell, Zobrist::Ship);
+        if (target.shipIndexByCell.empty()) {
+            target.sparseShipIndex[cell] = shipIndex;
+        } else {
+            target.shipIndexByCell[cell] = shipIndex;
         }
     }
+    
+    markSurroundingCells(ship);
 }
 
-void Field::markDestroyedShipCells(const Ship& ship) {
-    auto coords = ship.getDecksCoordinates();
-    
+void Field::markSurroundingCells(const ShipRecord& ship) {
+    // все 8 соседних клеток каждой палубы, кроме самих палуб
+    Layout& target = mutableLayout();
+    forEachHaloSpan(ship.x, ship.y, ship.size, ship.vertical, 
+                    [&](int begin, int len) {
+        target.blockedCells.orRange(begin, len, ~target.shipCells.getRange(begin, len));
+    });
+}
+
+void Field::markDestroyedShipCells(const ShipRecord& ship, std::vector<uint64_t>* journal) {
     // помечаем палубы как уничтоженные
-    for (const auto& coord : coords) {
-        cells[coord.second][coord.first].setState(CellState::Destroyed);
-    }
+    forEachDeckSpan(ship.x, ship.y, ship.size, ship.vertical, [&](int begin, int len) {
+        destroyedCells.setRange(begin, len);
+        toggleKeys(shotHash, begin, spanMask(len), Zobrist::Sunk);
+    });
     
-    // помечаем окружающие клетки как промахи (для отображения)
-    for (const auto& coord : coords) {
-        for (int dy = -1; dy <= 1; dy++) {
-            for (int dx = -1; dx <= 1; dx++) {
-                int nx = coord. first + dx;
-                int ny = coord.second + dy;
-                
-                if (isValidPosition(nx, ny)) {
-                    Cell& cell = cells[ny][nx];
-                    if (cell. getState() == CellState::Blocked || 
-                        cell.getState() == CellState::Empty) {
-                        cell.setState(CellState::Miss);
-                    }
-                }
-            }
-        }
-    }
+    // помечаем окружающие клетки как промахи (для отображения),
+    // для отката запоминаем, какие из них уже были промахами
+    forEachHaloSpan(ship.x, ship.y, ship.size, ship.vertical, 
+                    [&](int begin, int len) {
+        uint64_t before = missCells.getRange(begin, len);
+        if (journal) journal->push_back(before);
+        uint64_t added = ~layout->shipCells.getRange(begin, len) & ~before & spanMask(len);
+        missCells.orRange(begin, len, added);
+        toggleKeys(shotHash, begin, added, Zobrist::Miss);
+    });
 }
 
 bool Field::placeShip(int x, int y, int shipSize, bool vertical) {
@@ -130,120 +226,169 @@ bool Field::placeShip(int x, int y, int shipSize, bool vertical) {
         return false;
     }
     
-    auto ship = std::make_unique<Ship>(shipSize, x, y, vertical);
+    ShipRecord ship = ShipRecord::make(x, y, shipSize, vertical);
     
-    // помечаем клетки как занятые кораблём
-    auto coords = ship->getDecksCoordinates();
-    for (const auto& coord : coords) {
-        cells[coord.second][coord. first].setState(CellState::Ship);
-        cells[coord.second][coord. first].setShipId(ship->getId());
-    }
-    
-    // помечаем окружающие клетки
-    markSurroundingCells(*ship);
+    // помечаем клетки как занятые кораблём и окружающие клетки
+    occupyCells(ship, getShipsCount());
     
-    ships.push_back(std::move(ship));
+    mutableLayout().ships.push_back(ship);
+    shipHits.push_back(0);
     return true;
 }
 
+bool Field::placeShipRandomly(int shipSize) {
+    // на разреженном поле почти всё свободно: случайное положение с проверкой
+    // дешевле масок допустимых положений, которые стоят O(площади)
+    Rng& generator = random();
+    for (int attempt = 0; attempt < MAX_RANDOM_PLACEMENT_ATTEMPTS; attempt++) {
+        bool vertical = shipSize > 1 && (generator() & 1);
+        int x = generator.below(size);
+        int y = generator.below(size);
+        if (placeShip(x, y, shipSize, vertical)) return true;
+    }
+    return false;
+}
+
 bool Field::placeShipAuto(int shipSize) {
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<> distPos(0, size - 1);
-    std::uniform_int_distribution<> distDir(0, 1);
+    if (isSparse()) {
+        return placeShipRandomly(shipSize);
+    }
     
-    int attempts = 0;
-    const int maxAttempts = 1000;
+    // выбираем только среди допустимых положений
+    Bitboard freeCells = ~layout->shipCells;
+    freeCells.andNot(layout->blockedCells);
+    freeCells.andNot(missCells);
     
-    while (attempts < maxAttempts) {
-        int x = distPos(gen);
-        int y = distPos(gen);
-        bool vertical = distDir(gen) == 1;
-        
-        if (placeShip(x, y, shipSize, vertical)) {
-            return true;
-        }
-        attempts++;
+    Placement placement;
+    if (!FleetGenerator::forThread(size, layout->fleet).pickPlacement(freeCells, shipSize, random(), placement)) {
+        return false;
     }
-    
-    return false;
+    return placeShip(placement.x, placement.y, shipSize, placement.vertical);
 }
 
-void Field::placeAllShipsAuto() {
+bool Field::placeAllShipsAuto() {
     reset();
     
-    // 1 четырёхпалубный
-    placeShipAuto(4);
-    
-    // 2 трёхпалубных
-    for (int i = 0; i < 2; i++) {
-        placeShipAuto(3);
+    // после reset расстановка принадлежит только этому полю и дальше не пересоздаётся
+    const std::vector<int>& fleet = layout->fleet;
+    bool placedAll = true;
+    if (isSparse()) {
+        for (int shipSize : fleet) {
+            placedAll = placeShipRandomly(shipSize) && placedAll;
+        }
+        return placedAll;
     }
     
-    // 3 двухпалубных
-    for (int i = 0; i < 3; i++) {
-        placeShipAuto(2);
+    FleetGenerator& generator = FleetGenerator::forThread(size, fleet);
+    if (generator.generate(random())) {
+        for (const auto& placement : generator.getLayout()) {
+            placeShip(placement.x, placement.y, placement.size, placement.vertical);
+        }
+        return true;
     }
     
-    // 4 однопалубных
-    for (int i = 0; i < 4; i++) {
-        placeShipAuto(1);
+    // флот целиком не помещается - ставим сколько получится
+    for (int shipSize : fleet) {
+        placedAll = placeShipAuto(shipSize) && placedAll;
     }
+    return placedAll;
 }
 
 Field::AttackResult Field::attack(int x, int y) {
+    return applyAttack(x, y, nullptr);
+}
+
+Field::AttackResult Field::attack(int x, int y, AttackUndo& undo) {
+    undo.journalSize = undoJournal.size();
+    undo.result = applyAttack(x, y, &undoJournal);
+    undo.cell = (undo.result == AttackResult::AlreadyHit || undo.result == AttackResult::Invalid) 
+                ? -1 : cellIndex(x, y);
+    return undo.result;
+}
+
+void Field::undo(const AttackUndo& undo) {
+    if (undo.cell < 0) return;
+    
+    switch (undo.result) {
+        case AttackResult::Miss:
+            missCells.reset(undo.cell);
+            shotHash ^= Zobrist::key(undo.cell, Zobrist::Miss);
+            break;
+        case AttackResult::Destroyed: {
+            const ShipRecord& ship = layout->ships[getShipIndexAt(undo.cell % size, undo.cell / size)];
+            forEachDeckSpan(ship.x, ship.y, ship.size, ship.vertical, [&](int begin, int len) {
+                destroyedCells.resetRange(begin, len);
+                toggleKeys(shotHash, begin, spanMask(len), Zobrist::Sunk);
+            });
+            
+            // снимаем только промахи, появившиеся при потоплении
+            size_t position = undo.journalSize;
+            forEachHaloSpan(ship.x, ship.y, ship.size, ship.vertical, 
+                            [&](int begin, int len) {
+                uint64_t before = undoJournal[position++];
+                uint64_t added = missCells.getRange(begin, len) & ~before;
+                missCells.andNotRange(begin, len, added);
+                toggleKeys(shotHash, begin, added, Zobrist::Miss);
+            });
+            undoJournal.resize(undo.journalSize);
+            destroyedShipsCount--;
+            shipHits[getShipIndexAt(undo.cell % size, undo.cell / size)]--;
+            hitCells.reset(undo.cell);
+            shotHash ^= Zobrist::key(undo.cell, Zobrist::Hit);
+            break;
+        }
+        case AttackResult::Hit:
+            shipHits[getShipIndexAt(undo.cell % size, undo.cell / size)]--;
+            hitCells.reset(undo.cell);
+            shotHash ^= Zobrist::key(undo.cell, Zobrist::Hit);
+            break;
+        default:
+            break;
+    }
+}
+
+Field::AttackResult Field::applyAttack(int x, int y, std::vector<uint64_t>* journal) {
     if (!isValidPosition(x, y)) {
         return AttackResult::Invalid;
     }
     
-    Cell& cell = cells[y][x];
+    int index = cellIndex(x, y);
     
-    switch (cell.getState()) {
-        case CellState::Empty:
-        case CellState::Blocked:
-            cell.setState(CellState::Miss);
-            return AttackResult::Miss;
-            
-        case CellState::Ship: {
-            cell.setState(CellState::Hit);
-            int shipId = cell. getShipId();
-            
-            // находим корабль и регистрируем попадание
-            for (auto& ship : ships) {
-                if (ship->getId() == shipId) {
-                    ship->hit();
-                    if (ship->isDestroyed()) {
-                        markDestroyedShipCells(*ship);
-                        destroyedShipsCount++;
-                        return AttackResult::Destroyed;
-                    }
-                    return AttackResult::Hit;
-                }
-            }
-            return AttackResult::Hit;
-        }
-        
-        case CellState::Miss:
-        case CellState::Hit:
-        case CellState::Destroyed:
-            return AttackResult::AlreadyHit;
-            
-        default:
-            return AttackResult::Invalid;
+    if (hitCells.test(index) || missCells.test(index)) {
+        return AttackResult::AlreadyHit;
+    }
+    
+    if (!layout->shipCells.test(index)) {
+        missCells.set(index);
+        shotHash ^= Zobrist::key(index, Zobrist::Miss);
+        return AttackResult::Miss;
+    }
+    
+    hitCells.set(index);
+    shotHash ^= Zobrist::key(index, Zobrist::Hit);
+    
+    // корабль потоплен, когда подбиты все его палубы; расстановка при этом не меняется
+    int shipIndex = getShipIndexAt(x, y);
+    const ShipRecord& ship = layout->ships[shipIndex];
+    if (++shipHits[shipIndex] == ship.size) {
+        markDestroyedShipCells(ship, journal);
+        destroyedShipsCount++;
+        return AttackResult::Destroyed;
     }
+    return AttackResult::Hit;
 }
 
 void Field::draw(bool hideShips) const {
     std::cout << "   ";
     for (int x = 0; x < size; x++) {
-        std::cout << static_cast<char>('A' + x) << " ";
+        std::cout << columnLabel(x) << " ";
     }
     std::cout << std::endl;
     
     for (int y = 0; y < size; y++) {
         std::cout << std::setw(2) << (y + 1) << " ";
         for (int x = 0; x < size; x++) {
-            const Cell& cell = cells[y][x];
+            const Cell cell = getCell(x, y);
             
             if (hideShips && (cell.getState() == CellState::Ship || 
                              cell.getState() == CellState::Blocked)) {
@@ -270,7 +415,7 @@ void Field::drawWithColors(bool hideShips) const {
     // заголовок
     std::cout << CYAN << "   ";
     for (int x = 0; x < size; x++) {
-        std::cout << static_cast<char>('A' + x) << " ";
+        std::cout << columnLabel(x) << " ";
     }
     std::cout << RESET << std::endl;
     
@@ -278,7 +423,7 @@ void Field::drawWithColors(bool hideShips) const {
     for (int y = 0; y < size; y++) {
         std::cout << CYAN << std::setw(2) << (y + 1) << " " << RESET;
         for (int x = 0; x < size; x++) {
-            const Cell& cell = cells[y][x];
+            const Cell cell = getCell(x, y);
             
             if (hideShips && (cell.getState() == CellState::Ship || 
                              cell.getState() == CellState::Blocked)) {
@@ -313,26 +458,41 @@ void Field::drawWithColors(bool hideShips) const {
 }
 
 void Field::reset() {
-    ships.clear();
+    // общую расстановку не трогаем - заводим свою пустую
+    if (layout.use_count() > 1) {
+        layout = std::make_shared<Layout>(size, layout->fleet);
+    } else {
+        layout->clear();
+    }
     destroyedShipsCount = 0;
-    for (int y = 0; y < size; y++) {
-        for (int x = 0; x < size; x++) {
-            cells[y][x] = Cell(x, y);
-        }
+    shotHash = 0;
+    undoJournal.clear();
+    hitCells.clear();
+    missCells.clear();
+    destroyedCells.clear();
+    shipHits.clear();
+}
+
+std::string Field::columnLabel(int x) {
+    // биективная запись по основанию 26
+    std::string label;
+    for (int n = x + 1; n > 0; n = (n - 1) / 26) {
+        label.insert(label.begin(), static_cast<char>('A' + (n - 1) % 26));
     }
+    return label;
 }
 
 std::ostream& operator<<(std::ostream& os, const Field& field) {
     os << "   ";
     for (int x = 0; x < field.size; x++) {
-        os << static_cast<char>('A' + x) << " ";
+        os << Field::columnLabel(x) << " ";
     }
     os << std::endl;
     
     for (int y = 0; y < field.size; y++) {
         os << std::setw(2) << (y + 1) << " ";
         for (int x = 0; x < field.size; x++) {
-            os << field.cells[y][x] << " ";
+            os << field.getCell(x, y) << " ";
         }
         os << std::endl;
     }
@@ -3,29 +3,81 @@
 
 #include "Cell.h"
 #include "Ship.h"
+#include "Bitboard.h"
+#include "BoardConfig.h"
+#include "Zobrist.h"
+#include "Random.h"
 #include <vector>
 #include <memory>
+#include <algorithm>
+#include <string>
+#include <unordered_map>
 
 // размер поля по умолчанию
 const int DEFAULT_FIELD_SIZE = 10;
 
 // класс игрового поля
+// состояние хранится набором битовых досок, а Cell собирается по запросу
+// копия поля разделяет с оригиналом расстановку флота (копирование при записи)
+// и копирует только выстрелы, поэтому копии для перебора ходов почти бесплатны
 class Field {
+public:
+    // результат выстрела
+    enum class AttackResult { Miss, Hit, Destroyed, AlreadyHit, Invalid };
+    
 private:
+    // попыток случайного положения корабля на разреженном поле
+    static const int MAX_RANDOM_PLACEMENT_ATTEMPTS = 10000;
+    
+    // расстановка флота: меняется только при размещении кораблей и сбросе
+    struct Layout {
+        std::vector<int> fleet;            // длины кораблей по убыванию для автоматической расстановки
+        Bitboard shipCells;                // палубы кораблей
+        Bitboard blockedCells;             // клетки вокруг кораблей
+        std::vector<ShipRecord> ships;     // непрерывный пул, ёмкость - на весь флот
+        std::vector<int> shipIndexByCell;  // номер корабля в ships для каждой клетки, -1 - пусто
+        std::unordered_map<int, int> sparseShipIndex;  // то же для разреженного поля: только палубы
+        uint64_t emptyHash;                // хеш поля без кораблей
+        uint64_t hash;                     // хеш Зобриста расстановки
+        
+        Layout(int size, const std::vector<int>& fleet);
+        void clear();
+    };
+    
     int size;
-    std::vector<std::vector<Cell>> cells;
-    std::vector<std::unique_ptr<Ship>> ships;
+    std::shared_ptr<Layout> layout;  // общая для копий, пока одна из них не изменит расстановку
+    Bitboard hitCells;        // подбитые палубы
+    Bitboard missCells;       // промахи и открытые клетки вокруг потопленных
+    Bitboard destroyedCells;  // палубы потопленных кораблей
+    std::vector<uint16_t> shipHits;  // подбитых палуб по номеру корабля: потопление за O(1)
     int destroyedShipsCount;
+    uint64_t shotHash;        // хеш Зобриста выстрелов
+    std::vector<uint64_t> undoJournal;  // прежние промахи вокруг потопленных кораблей для undo, не копируется
+    Rng* rng;                 // генератор автоматической расстановки, nullptr - генератор потока
     
     // приватные методы
     bool isValidPosition(int x, int y) const;
-    void markSurroundingCells(const Ship& ship);
-    void markDestroyedShipCells(const Ship& ship);
+    int cellIndex(int x, int y) const { return y * size + x; }
+    Layout& mutableLayout();
+    Rng& random() const { return rng ? *rng : threadRng(); }
+    void occupyCells(const ShipRecord& ship, int shipIndex);
+    void markSurroundingCells(const ShipRecord& ship);
+    void markDestroyedShipCells(const ShipRecord& ship, std::vector<uint64_t>* journal);
+    bool placeShipRandomly(int shipSize);
+    // выстрел; journal - куда записать прежние промахи вокруг потопленного для undo, nullptr - без отката
+    AttackResult applyAttack(int x, int y, std::vector<uint64_t>* journal);
+    
+    // обход отрезков строк (не длиннее 64 клеток), занятых палубами и ореолом корабля
+    template<typename F>
+    void forEachDeckSpan(int x, int y, int shipSize, bool vertical, F f) const;
+    template<typename F>
+    void forEachHaloSpan(int x, int y, int shipSize, bool vertical, F f) const;
     
 public:
     // конструкторы
     Field();
     explicit Field(int size);
+    explicit Field(const BoardConfig& config);
     
     Field(const Field& other);
     
@@ -33,62 +85,117 @@ public:
     
     ~Field() = default;
     
+    // снимок состояния поля: расстановка разделяется, выстрелы копируются
+    class Snapshot {
+    private:
+        friend class Field;
+        std::shared_ptr<Layout> layout;
+        Bitboard hitCells;
+        Bitboard missCells;
+        Bitboard destroyedCells;
+        std::vector<uint16_t> shipHits;
+        int destroyedShipsCount = 0;
+        uint64_t shotHash = 0;
+    };
+    
+    Snapshot snapshot() const;
+    void saveSnapshot(Snapshot& snapshot) const;  // в готовый снимок, без выделения памяти
+    void restore(const Snapshot& snapshot);
+    
     // методы для работы с кораблями
     bool canPlaceShip(int x, int y, int shipSize, bool vertical) const;
     bool placeShip(int x, int y, int shipSize, bool vertical);
     bool placeShipAuto(int shipSize);
-    void placeAllShipsAuto();
+    // false - флот целиком не поместился, на поле остаются корабли, которые встали
+    bool placeAllShipsAuto();
     
     // шаблонный метод для размещения конкретного типа корабля
     template<typename T>
     bool placeSpecificShip(int x, int y, bool vertical);
     
     // методы для атаки
-    enum class AttackResult { Miss, Hit, Destroyed, AlreadyHit, Invalid };
     AttackResult attack(int x, int y);
     
+    // обратимый выстрел для перебора ходов на месте, без копий поля
+    struct AttackUndo {
+        int cell = -1;                              // клетка выстрела, -1 - поле не изменилось
+        AttackResult result = AttackResult::Invalid;
+        size_t journalSize = 0;                     // длина журнала поля до выстрела
+    };
+    
+    // выстрел с записью отката; откатывать строго в обратном порядке (стеком)
+    AttackResult attack(int x, int y, AttackUndo& undo);
+    void undo(const AttackUndo& undo);
+    
     // отображение
     void draw(bool hideShips = false) const;
     void drawWithColors(bool hideShips = false) const;
     
+    // генератор для автоматической расстановки; поле его не владеет, 
+    // при присваивании остаётся свой, копия получает тот же
+    void setRng(Rng* generator) { rng = generator; }
+    
     // геттеры
     int getSize() const { return size; }
-    int getShipsCount() const { return ships.size(); }
+    const std::vector<int>& getFleet() const { return layout->fleet; }
+    // поле хранится разреженно: память и цена хода зависят от кораблей и выстрелов, а не от площади
+    bool isSparse() const { return hitCells.isSparse(); }
+    size_t memoryUsage() const;
+    int getShipsCount() const { return layout->ships.size(); }
     int getDestroyedShipsCount() const { return destroyedShipsCount; }
-    int getAliveShipsCount() const { return ships. size() - destroyedShipsCount; }
-    bool allShipsDestroyed() const { return destroyedShipsCount >= static_cast<int>(ships.size()); }
-    Cell& getCell(int x, int y) { return cells[y][x]; }
-    const Cell& getCell(int x, int y) const { return cells[y][x]; }
+    int getAliveShipsCount() const { return getShipsCount() - destroyedShipsCount; }
+    bool allShipsDestroyed() const { return destroyedShipsCount >= getShipsCount(); }
+    int getShipIndexAt(int x, int y) const;
+    const ShipRecord& getShip(int index) const { return layout->ships[index]; }
+    int getShipHitCount(int index) const { return shipHits[index]; }
+    int getShipRemainingDecks(int index) const { return layout->ships[index].size - shipHits[index]; }
+    
+    // хеш Зобриста полного состояния, обновляется при каждой расстановке и выстреле
+    uint64_t getHash() const { return layout->hash ^ shotHash; }
+    CellState getCellState(int x, int y) const;
+    Cell getCell(int x, int y) const;
     
     // сброс поля
     void reset();
     
+    // подпись столбца: A..Z, затем AA, AB, ...
+    static std::string columnLabel(int x);
+    
     friend std::ostream& operator<<(std::ostream& os, const Field& field);
 };
 
+template<typename F>
+void Field::forEachDeckSpan(int x, int y, int shipSize, bool vertical, F f) const {
+    if (vertical) {
+        for (int i = 0; i < shipSize; i++) {
+            f(cellIndex(x, y + i), 1);
+        }
+    } else {
+        for (int i = 0; i < shipSize; i += 64) {
+            f(cellIndex(x + i, y), std::min(64, shipSize - i));
+        }
+    }
+}
+
+template<typename F>
+void Field::forEachHaloSpan(int x, int y, int shipSize, bool vertical, F f) const {
+    int x0 = std::max(x - 1, 0);
+    int y0 = std::max(y - 1, 0);
+    int x1 = std::min(vertical ? x + 1 : x + shipSize, size - 1);
+    int y1 = std::min(vertical ? y + shipSize : y + 1, size - 1);
+    
+    for (int row = y0; row <= y1; row++) {
+        for (int col = x0; col <= x1; col += 64) {
+            f(cellIndex(col, row), std::min(64, x1 - col + 1));
+        }
+    }
+}
+
 template<typename T>
 bool Field::placeSpecificShip(int x, int y, bool vertical) {
+    // на поле хранится только запись корабля, тип задаёт длину
     T tempShip;
-    int shipSize = tempShip.getSize();
-    
-    if (!canPlaceShip(x, y, shipSize, vertical)) {
-        return false;
-    }
-    
-    auto ship = std::make_unique<T>(x, y, vertical);
-    
-    // помечаем клетки как занятые кораблём
-    auto coords = ship->getDecksCoordinates();
-    for (const auto& coord : coords) {
-        cells[coord.second][coord.first]. setState(CellState::Ship);
-        cells[coord.second][coord.first].setShipId(ship->getId());
-    }
-    
-    // помечаем окружающие клетки
-    markSurroundingCells(*ship);
-    
-    ships.push_back(std::move(ship));
-    return true;
+    return placeShip(x, y, tempShip.getSize(), vertical);
 }
 
-#endif
\ No newline at end of file
+#endif
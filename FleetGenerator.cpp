@@ -0,0 +1,134 @@
+#include "FleetGenerator.h"
+#include <algorithm>
+#include <functional>
+#include <memory>
+
+FleetGenerator::FleetGenerator(int size, const std::vector<int>& fleet) 
+    : size(size), fleet(fleet), masks(size), occupied(size * size), freeCells(size * size), 
+      horizontal(size * size), vertical(size * size), sweeps(DEFAULT_SWEEPS) {
+    std::sort(this->fleet.begin(), this->fleet.end(), std::greater<int>());
+    
+    for (int length : this->fleet) {
+        masks.ensureLength(length);
+    }
+    
+    layout.resize(this->fleet.size());
+    shipMasks.assign(this->fleet.size(), Bitboard(size * size));
+    triedStarts.assign(this->fleet.size() * 2, Bitboard(size * size));
+}
+
+std::vector<int> FleetGenerator::standardFleet() {
+    return {4, 3, 3, 2, 2, 2, 1, 1, 1, 1};
+}
+
+void FleetGenerator::setShipMask(int ship, const Placement& placement) {
+    masks.shipMask(placement.y * size + placement.x, placement.size, placement.vertical, shipMasks[ship]);
+}
+
+void FleetGenerator::computeFreeCells(const Bitboard& ships) {
+    masks.dilate(ships, freeCells);
+    const Bitboard& fullBoard = masks.getFullBoard();
+    for (int i = 0; i < freeCells.getWordCount(); i++) {
+        freeCells.setWord(i, fullBoard.getWord(i) & ~freeCells.getWord(i));
+    }
+}
+
+bool FleetGenerator::chooseStart(Rng& rng, int length, Placement& result) {
+    int horizontalCount = horizontal.count();
+    int total = horizontalCount + vertical.count();
+    if (total == 0) return false;
+    
+    int choice = rng.below(total);
+    bool isVertical = choice >= horizontalCount;
+    int start = isVertical ? vertical.select(choice - horizontalCount) : horizontal.select(choice);
+    
+    result = {start % size, start / size, length, isVertical};
+    return true;
+}
+
+bool FleetGenerator::pickPlacement(const Bitboard& free, int length, Rng& rng, Placement& result) {
+    masks.ensureLength(length);
+    masks.legalStarts(free, length, false, horizontal);
+    masks.legalStarts(free, length, true, vertical);
+    return chooseStart(rng, length, result);
+}
+
+bool FleetGenerator::placeSequentially(Rng& rng) {
+    int shipCount = static_cast<int>(fleet.size());
+    occupied.clear();
+    triedStarts[0].clear();
+    triedStarts[1].clear();
+    
+    int ship = 0;
+    int backtracks = 0;
+    while (ship < shipCount) {
+        int length = fleet[ship];
+        computeFreeCells(occupied);
+        
+        // отбрасываем положения, уже приведшие к тупику на этом шаге
+        masks.legalStarts(freeCells, length, false, horizontal);
+        horizontal.andNot(triedStarts[ship * 2]);
+        masks.legalStarts(freeCells, length, true, vertical);
+        vertical.andNot(triedStarts[ship * 2 + 1]);
+        
+        Placement placement;
+        if (!chooseStart(rng, length, placement)) {
+            // тупик: откатываем предыдущий корабль
+            if (ship == 0 || ++backtracks > MAX_BACKTRACKS) return false;
+            ship--;
+            occupied.andNot(shipMasks[ship]);
+            continue;
+        }
+        
+        triedStarts[ship * 2 + (placement.vertical ? 1 : 0)].set(placement.y * size + placement.x);
+        layout[ship] = placement;
+        setShipMask(ship, placement);
+        occupied |= shipMasks[ship];
+        ship++;
+        
+        // следующий корабль начинает перебор с чистого листа
+        if (ship < shipCount) {
+            triedStarts[ship * 2].clear();
+            triedStarts[ship * 2 + 1].clear();
+        }
+    }
+    return true;
+}
+
+void FleetGenerator::relocate(int ship, Rng& rng) {
+    // корабли не пересекаются, поэтому остальные = все без текущего
+    occupied.andNot(shipMasks[ship]);
+    computeFreeCells(occupied);
+    
+    // текущее положение всегда допустимо, поэтому выбор непуст
+    Placement placement;
+    if (pickPlacement(freeCells, fleet[ship], rng, placement)) {
+        layout[ship] = placement;
+        setShipMask(ship, placement);
+    }
+    occupied |= shipMasks[ship];
+}
+
+bool FleetGenerator::generate(Rng& rng) {
+    if (!placeSequentially(rng)) return false;
+    
+    int shipCount = static_cast<int>(fleet.size());
+    for (int sweep = 0; sweep < sweeps; sweep++) {
+        for (int ship = 0; ship < shipCount; ship++) {
+            relocate(ship, rng);
+        }
+    }
+    return true;
+}
+
+FleetGenerator& FleetGenerator::forThread(int size, const std::vector<int>& fleet) {
+    thread_local std::vector<std::unique_ptr<FleetGenerator>> generators;
+    for (auto& generator : generators) {
+        if (generator->getSize() == size && generator->getFleet().size() == fleet.size() &&
+            std::is_permutation(fleet.begin(), fleet.end(), generator->getFleet().begin())) {
+            return *generator;
+        }
+    }
+    generators.push_back(std::make_unique<FleetGenerator>(size, fleet));
+    return *generators.back();
+}
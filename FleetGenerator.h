@@ -0,0 +1,69 @@
+#ifndef FLEET_GENERATOR_H
+#define FLEET_GENERATOR_H
+
+#include "PlacementMasks.h"
+#include "Random.h"
+#include <vector>
+
+// генератор случайных расстановок флота
+// выбирает корабли только среди допустимых положений (маски на битовых досках),
+// при тупике откатывается назад, а затем выравнивает распределение 
+// проходами Гиббса: каждый корабль перевыбирается равновероятно среди 
+// положений, допустимых при остальных кораблях
+class FleetGenerator {
+private:
+    // предел откатов: на тесном поле полный перебор экспоненциален
+    static const int MAX_BACKTRACKS = 20000;
+    // проходов Гиббса по умолчанию (simulate uniformity): смещение частот клеток
+    // падает в 3-4 раза за проход; на тесном 5x5 с флотом 3,2,1,1 после 4 проходов
+    // частоты расстановок уже согласуются с полным перебором, а частоты клеток - ещё нет
+    // (z около 4 на миллионе выборок), после 6 проходов согласуются и они (z около 2)
+    static const int DEFAULT_SWEEPS = 6;
+    
+    int size;
+    std::vector<int> fleet;  // длины кораблей по убыванию
+    PlacementMasks masks;
+    
+    // рабочее состояние, переиспользуется между вызовами
+    std::vector<Placement> layout;
+    std::vector<Bitboard> shipMasks;
+    std::vector<Bitboard> triedStarts;
+    Bitboard occupied;
+    Bitboard freeCells;
+    Bitboard horizontal;
+    Bitboard vertical;
+    int sweeps;
+    
+    void setShipMask(int ship, const Placement& placement);
+    void computeFreeCells(const Bitboard& ships);
+    bool chooseStart(Rng& rng, int length, Placement& result);
+    bool placeSequentially(Rng& rng);
+    void relocate(int ship, Rng& rng);
+    
+public:
+    FleetGenerator(int size, const std::vector<int>& fleet);
+    
+    int getSize() const { return size; }
+    const std::vector<int>& getFleet() const { return fleet; }
+    
+    // число проходов Гиббса после начальной расстановки; 0 - только смещённая последовательная
+    void setSweeps(int count) { sweeps = count; }
+    
+    const PlacementMasks& getMasks() const { return masks; }
+    
+    // случайное положение корабля длины length на свободных клетках freeCells
+    bool pickPlacement(const Bitboard& freeCells, int length, Rng& rng, Placement& result);
+    
+    // новая расстановка всего флота; false - флот не помещается на поле
+    bool generate(Rng& rng);
+    const std::vector<Placement>& getLayout() const { return layout; }
+    
+    // флот по умолчанию: 1x4, 2x3, 3x2, 4x1
+    static std::vector<int> standardFleet();
+    
+    // общий для потока генератор поля size с флотом fleet (порядок длин не важен):
+    // кэш, чтобы поля и партии не пересчитывали маски и не держали свои буферы
+    static FleetGenerator& forThread(int size, const std::vector<int>& fleet);
+};
+
+#endif
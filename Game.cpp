@@ -11,35 +11,75 @@ int Game::player2Wins = 0;
 
 // конструкторы
 
-Game::Game() : mode(GameMode::PlayerVsComputer), state(GameState::NotStarted), turnCount(0) {
-    player1 = std::make_unique<HumanPlayer>("Игрок");
-    player2 = std::make_unique<ComputerPlayer>("Компьютер");
-    currentPlayer = player1.get();
-    opponent = player2. get();
+Game::Game() 
+    : Game(GameMode::PlayerVsComputer) {
 }
 
-Game::Game(GameMode mode) : mode(mode), state(GameState::NotStarted), turnCount(0) {
+Game::Game(GameMode mode, const BoardConfig& config) 
+    : mode(mode), state(GameState::NotStarted), turnCount(0), 
+      rng(threadRng()()), currentSeed(0), record(nullptr) {
     if (mode == GameMode::PlayerVsComputer) {
-        player1 = std::make_unique<HumanPlayer>("Игрок");
-        player2 = std::make_unique<ComputerPlayer>("Компьютер");
+        player1 = std::make_unique<HumanPlayer>("Игрок", config);
+        player2 = std::make_unique<ComputerPlayer>("Компьютер", TargetingStrategy::HuntTarget, config);
     } else {
-        player1 = std::make_unique<ComputerPlayer>("Компьютер 1");
-        player2 = std::make_unique<ComputerPlayer>("Компьютер 2");
+        player1 = std::make_unique<ComputerPlayer>("Компьютер 1", TargetingStrategy::HuntTarget, config);
+        player2 = std::make_unique<ComputerPlayer>("Компьютер 2", TargetingStrategy::HuntTarget, config);
     }
     currentPlayer = player1.get();
     opponent = player2.get();
+    attachRng();
+}
+
+Game::Game(TargetingStrategy player1Strategy, TargetingStrategy player2Strategy, const BoardConfig& config) 
+    : mode(GameMode::ComputerVsComputer), state(GameState::NotStarted), turnCount(0), 
+      rng(threadRng()()), currentSeed(0), record(nullptr) {
+    player1 = std::make_unique<ComputerPlayer>("Компьютер 1", player1Strategy, config);
+    player2 = std::make_unique<ComputerPlayer>("Компьютер 2", player2Strategy, config);
+    currentPlayer = player1.get();
+    opponent = player2.get();
+    attachRng();
 }
 
-Game::Game(const std::string& player1Name, const std::string& player2Name) 
-    : mode(GameMode::PlayerVsComputer), state(GameState::NotStarted), turnCount(0) {
-    player1 = std::make_unique<HumanPlayer>(player1Name);
-    player2 = std::make_unique<ComputerPlayer>(player2Name);
+Game::Game(const std::string& player1Name, const std::string& player2Name, const BoardConfig& config) 
+    : mode(GameMode::PlayerVsComputer), state(GameState::NotStarted), turnCount(0), 
+      rng(threadRng()()), currentSeed(0), record(nullptr) {
+    player1 = std::make_unique<HumanPlayer>(player1Name, config);
+    player2 = std::make_unique<ComputerPlayer>(player2Name, TargetingStrategy::HuntTarget, config);
     currentPlayer = player1.get();
     opponent = player2. get();
+    attachRng();
 }
 
 // методы
 
+void Game::attachRng() {
+    player1->setRng(&rng);
+    player2->setRng(&rng);
+}
+
+void Game::setRecord(GameRecord* target) {
+    record = target;
+    if (record) {
+        int cells = player1->getField().getSize() * player1->getField().getSize();
+        record->shots.reserve(2 * cells);
+        record->fleets[0].reserve(player1->getField().getFleet().size());
+        record->fleets[1].reserve(player2->getField().getFleet().size());
+    }
+}
+
+void Game::beginRecord() {
+    if (!record) return;
+    record->clear();
+    record->seed = currentSeed;
+    const AbstractPlayer* players[2] = {player1.get(), player2.get()};
+    for (int i = 0; i < 2; i++) {
+        const Field& field = players[i]->getField();
+        for (int ship = 0; ship < field.getShipsCount(); ship++) {
+            record->fleets[i].push_back(field.getShip(ship));
+        }
+    }
+}
+
 void Game::clearScreen() const {
 #ifdef _WIN32
     system("cls");
@@ -48,16 +88,23 @@ void Game::clearScreen() const {
 #endif
 }
 
-void Game::initialize() {
+bool Game::initialize() {
     state = GameState::PlacingShips;
     
+    // своё зерно у каждой партии, чтобы записанную партию можно было повторить
+    currentSeed = seedSource ? (*seedSource)() : threadRng()();
+    rng.seed(currentSeed);
+    
     std::cout << "\n========================================\n";
     std::cout << "         МОРСКОЙ БОЙ - НАЧАЛО ИГРЫ\n";
     std::cout << "========================================\n\n";
     
     // расстановка кораблей первого игрока
     std::cout << ">>> " << player1->getName() << ", расставьте корабли <<<\n";
-    player1->placeShips();
+    if (!player1->placeShips()) {
+        state = GameState::NotStarted;
+        return false;
+    }
     
     std::cout << "\nНажмите Enter для продолжения...";
     std::cin.ignore();
@@ -66,15 +113,24 @@ void Game::initialize() {
     // расстановка кораблей второго игрока
     if (! player2->isHuman()) {
         std::cout << "\n" << player2->getName() << " расставляет корабли.. .\n";
-        player2->placeShips();
+        if (!player2->placeShips()) {
+            std::cout << "Флот компьютера не помещается на поле!\n";
+            state = GameState::NotStarted;
+            return false;
+        }
         std::cout << "Корабли компьютера расставлены!\n";
     } else {
         clearScreen();
         std::cout << ">>> " << player2->getName() << ", расставьте корабли <<<\n";
-        player2->placeShips();
+        if (!player2->placeShips()) {
+            state = GameState::NotStarted;
+            return false;
+        }
     }
     
+    beginRecord();
     state = GameState::InProgress;
+    return true;
 }
 
 void Game::displayFields() const {
@@ -85,14 +141,24 @@ void Game::displayFields() const {
     std::cout << CYAN << "║" << RESET << "        ВАШЕ ПОЛЕ                    ПОЛЕ ПРОТИВНИКА        " << CYAN << "║" << RESET << "\n";
     std::cout << CYAN << "╚════════════════════════════════════════════════════════════╝" << RESET << "\n\n";
     
+    int size = player1->getField().getSize();
+    int cellWidth = static_cast<int>(Field::columnLabel(size - 1).size()) + 1;
+    int rowWidth = static_cast<int>(std::to_string(size).size());
+    
     // заголовки
-    std::cout << "   A B C D E F G H I J       A B C D E F G H I J\n";
+    std::string header(rowWidth + 1, ' ');
+    for (int x = 0; x < size; x++) {
+        std::string label = Field::columnLabel(x);
+        header += label + std::string(cellWidth - label.size(), ' ');
+    }
+    std::cout << header << "    " << header << "\n";
+    std::string padding(cellWidth - 1, ' ');
     
     // поля
-    for (int y = 0; y < 10; y++) {
+    for (int y = 0; y < size; y++) {
         // левое поле (игрока - показываем корабли)
-        std::cout << std::setw(2) << (y + 1) << " ";
-        for (int x = 0; x < 10; x++) {
+        std::cout << std::setw(rowWidth) << (y + 1) << " ";
+        for (int x = 0; x < size; x++) {
             const Cell& cell = player1->getField(). getCell(x, y);
             
             const std::string BLUE = "\033[34m";
@@ -120,13 +186,14 @@ void Game::displayFields() const {
                 default:
                     std::cout << "?  ";
             }
+            std::cout << padding;
         }
         
         std::cout << "    ";
         
         // правое поле (противника - скрываем корабли)
-        std::cout << std::setw(2) << (y + 1) << " ";
-        for (int x = 0; x < 10; x++) {
+        std::cout << std::setw(rowWidth) << (y + 1) << " ";
+        for (int x = 0; x < size; x++) {
             const Cell& cell = player2->getField().getCell(x, y);
             
             const std::string BLUE = "\033[34m";
@@ -151,6 +218,7 @@ void Game::displayFields() const {
                 default:
                     std::cout << "? ";
             }
+            std::cout << padding;
         }
         std::cout << "\n";
     }
@@ -171,34 +239,53 @@ void Game::switchTurn() {
     std::swap(currentPlayer, opponent);
 }
 
-void Game::processAttack(int x, int y, AbstractPlayer* attacker, AbstractPlayer* target) {
+Field::AttackResult Game::applyAttack(int x, int y, AbstractPlayer* attacker, AbstractPlayer* target) {
     attacker->incrementShots();
     
     Field::AttackResult result = target->getField().attack(x, y);
     
-    char colLetter = 'A' + x;
-    std::cout << attacker->getName() << " стреляет: " << colLetter << (y + 1) << " - ";
+    if (record && result != Field::AttackResult::AlreadyHit && result != Field::AttackResult::Invalid) {
+        record->shots.push_back(y * target->getField().getSize() + x);
+    }
+    
+    if (! attacker->isHuman()) {
+        static_cast<ComputerPlayer*>(attacker)->onAttackResult(x, y, result);
+    }
     
     switch (result) {
         case Field::AttackResult::Miss:
-            std::cout << "\033[33mМимо!\033[0m\n";
             switchTurn();
             break;
             
         case Field::AttackResult::Hit:
-            std::cout << "\033[31mПопадание!\033[0m\n";
+        case Field::AttackResult::Destroyed:
             attacker->incrementHits();
-            if (! attacker->isHuman()) {
-                dynamic_cast<ComputerPlayer*>(attacker)->onHit(x, y);
-            }
+            break;
+            
+        case Field::AttackResult::AlreadyHit:
+        case Field::AttackResult::Invalid:
+            break;
+    }
+    
+    return result;
+}
+
+void Game::processAttack(int x, int y, AbstractPlayer* attacker, AbstractPlayer* target) {
+    Field::AttackResult result = applyAttack(x, y, attacker, target);
+    
+    std::cout << attacker->getName() << " стреляет: " << Field::columnLabel(x) << (y + 1) << " - ";
+    
+    switch (result) {
+        case Field::AttackResult::Miss:
+            std::cout << "\033[33mМимо!\033[0m\n";
+            break;
+            
+        case Field::AttackResult::Hit:
+            std::cout << "\033[31mПопадание!\033[0m\n";
             break;
             
         case Field::AttackResult::Destroyed:
             std::cout << "\033[31;1mУбит!\033[0m\n";
-            attacker->incrementHits();
-            if (!attacker->isHuman()) {
-                dynamic_cast<ComputerPlayer*>(attacker)->onDestroyed();
-            }
             break;
             
         case Field::AttackResult::AlreadyHit:
@@ -211,8 +298,8 @@ void Game::processAttack(int x, int y, AbstractPlayer* attacker, AbstractPlayer*
     }
 }
 
-void Game::start() {
-    initialize();
+bool Game::start() {
+    return initialize();
 }
 
 void Game::run() {
@@ -249,6 +336,7 @@ void Game::run() {
         if (target->hasLost()) {
             state = GameState::Finished;
             gamesPlayed++;
+            if (record) record->winner = (attacker == player1.get()) ? 1 : 2;
             
             if (attacker == player1. get()) {
                 player1Wins++;
@@ -282,9 +370,62 @@ void Game::run() {
     }
 }
 
+void Game::setTranspositionTable(TranspositionTable* table) {
+    for (AbstractPlayer* player : {player1.get(), player2.get()}) {
+        if (auto* computer = dynamic_cast<ComputerPlayer*>(player)) {
+            computer->setTranspositionTable(table);
+        }
+    }
+}
+
+GameResult Game::runHeadless() {
+    return runHeadless(threadRng()());
+}
+
+GameResult Game::runHeadless(uint64_t seed) {
+    GameResult result = {0, 0, 0, 0, seed};
+    if (player1->isHuman() || player2->isHuman()) {
+        return result;
+    }
+    
+    // сброс игроков перемешивает клетки, поэтому зерно ставится до него
+    currentSeed = seed;
+    rng.seed(seed);
+    reset();
+    // флот не помещается - партия не сыграна (winner = 0)
+    if (!player1->placeShips() || !player2->placeShips()) {
+        return result;
+    }
+    beginRecord();
+    state = GameState::InProgress;
+    
+    while (state == GameState::InProgress) {
+        turnCount++;
+        
+        AbstractPlayer* attacker = currentPlayer;
+        AbstractPlayer* target = opponent;
+        
+        auto coords = attacker->makeMove();
+        applyAttack(coords.first, coords.second, attacker, target);
+        
+        if (target->hasLost()) {
+            state = GameState::Finished;
+            result.winner = (attacker == player1.get()) ? 1 : 2;
+            if (record) record->winner = result.winner;
+        }
+    }
+    
+    result.turns = turnCount;
+    result.player1Shots = player1->getShotsCount();
+    result.player2Shots = player2->getShotsCount();
+    return result;
+}
+
 void Game::reset() {
     player1->getField().reset();
     player2->getField().reset();
+    player1->resetCounters();
+    player2->resetCounters();
     
     if (auto* comp = dynamic_cast<ComputerPlayer*>(player2.get())) {
         comp->reset();
@@ -2,7 +2,9 @@
 #define GAME_H
 
 #include "Player.h"
+#include "GameRecord.h"
 #include <memory>
+#include <optional>
 
 // режимы игры
 enum class GameMode {
@@ -18,6 +20,17 @@ enum class GameState {
     Finished
 };
 
+// итог одной партии без вывода на экран
+struct GameResult {
+    int winner;        // 1 или 2, 0 - партия не сыграна
+    int turns;
+    int player1Shots;
+    int player2Shots;
+    uint64_t seed;     // зерно партии: runHeadless(seed) повторяет её бит в бит
+    
+    int winnerShots() const { return winner == 1 ? player1Shots : player2Shots; }
+};
+
 // главный класс игры
 class Game {
 private:
@@ -28,6 +41,10 @@ private:
     GameMode mode;
     GameState state;
     int turnCount;
+    Rng rng;  // общий генератор игроков: расстановка и ходы обоих берутся из него
+    uint64_t currentSeed;
+    std::optional<Rng> seedSource;  // зёрна партий после seed(), без него - из генератора потока
+    GameRecord* record;  // куда записывается ход партии, nullptr - не записывать
     
     // статические члены
     static int gamesPlayed;
@@ -39,13 +56,19 @@ private:
     void displayFields() const;
     void displayStats() const;
     void processAttack(int x, int y, AbstractPlayer* attacker, AbstractPlayer* target);
+    Field::AttackResult applyAttack(int x, int y, AbstractPlayer* attacker, AbstractPlayer* target);
     void clearScreen() const;
+    void attachRng();
+    void beginRecord();
     
 public:
     // конструкторы
     Game();
-    Game(GameMode mode);
-    Game(const std::string& player1Name, const std::string& player2Name);
+    explicit Game(GameMode mode, const BoardConfig& config = BoardConfig());
+    Game(TargetingStrategy player1Strategy, TargetingStrategy player2Strategy, 
+         const BoardConfig& config = BoardConfig());
+    Game(const std::string& player1Name, const std::string& player2Name, 
+         const BoardConfig& config = BoardConfig());
     
     // запрет копирования
     Game(const Game&) = delete;
@@ -54,12 +77,29 @@ public:
     // деструктор
     ~Game() = default;
     
-    // основные методы
-    void initialize();
-    void start();
+    // основные методы; false - флот не поместился на поле, партия не начата
+    bool initialize();
+    bool start();
     void run();
     void reset();
     
+    // партия компьютер против компьютера без пауз и вывода;
+    // без зерна оно берётся из генератора потока и записывается в результат
+    // (повтор точен, если стратегии не делят таблицу транспозиций с другими партиями)
+    GameResult runHeadless();
+    GameResult runHeadless(uint64_t seed);
+    
+    // зерно для следующих партий в обычном режиме: initialize() берёт зёрна партий
+    // по порядку из генератора с этим зерном, так что серия партий повторяется
+    void seed(uint64_t seed) { seedSource.emplace(seed); }
+    
+    // запись партий: после расстановки в record попадают зерно и флоты, затем каждый выстрел;
+    // память record переиспользуется, так что запись в цикле симуляции не выделяет её
+    void setRecord(GameRecord* target);
+    
+    // таблица транспозиций для компьютерных игроков, nullptr - без кэша
+    void setTranspositionTable(TranspositionTable* table);
+    
     // геттеры
     GameState getState() const { return state; }
     GameMode getMode() const { return mode; }
@@ -0,0 +1,380 @@
+#include "GameRecord.h"
+#include <cstring>
+#include <algorithm>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    const char MAGIC[4] = {'S', 'B', 'G', 'R'};
+    const uint8_t VERSION = 1;
+    
+    // бит, нужных для чисел от 0 до value
+    int bitsFor(uint64_t value) {
+        int bits = 1;
+        while (bits < 64 && (value >> bits) != 0) bits++;
+        return bits;
+    }
+    
+    void putUint32(std::vector<uint8_t>& out, uint32_t value) {
+        for (int i = 0; i < 4; i++) {
+            out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+        }
+    }
+    
+    uint32_t getUint32(const uint8_t* in) {
+        return static_cast<uint32_t>(in[0]) | static_cast<uint32_t>(in[1]) << 8 |
+               static_cast<uint32_t>(in[2]) << 16 | static_cast<uint32_t>(in[3]) << 24;
+    }
+    
+    // упаковка битов младшими вперёд
+    class BitWriter {
+    private:
+        std::vector<uint8_t>& out;
+        uint64_t accumulator;
+        int count;
+    
+    public:
+        explicit BitWriter(std::vector<uint8_t>& out) : out(out), accumulator(0), count(0) {}
+        
+        void put(uint64_t value, int bits) {
+            // не больше 32 бит за раз, чтобы накопитель не переполнился
+            while (bits > 32) {
+                put(value & 0xFFFFFFFFULL, 32);
+                value >>= 32;
+                bits -= 32;
+            }
+            accumulator |= (value & ((1ULL << bits) - 1)) << count;
+            count += bits;
+            while (count >= 8) {
+                out.push_back(static_cast<uint8_t>(accumulator));
+                accumulator >>= 8;
+                count -= 8;
+            }
+        }
+        
+        void finish() {
+            if (count > 0) out.push_back(static_cast<uint8_t>(accumulator));
+            accumulator = 0;
+            count = 0;
+        }
+    };
+    
+    class BitReader {
+    private:
+        const uint8_t* current;
+        const uint8_t* end;
+        uint64_t accumulator;
+        int count;
+        bool overrun;
+    
+    public:
+        BitReader(const uint8_t* begin, const uint8_t* end)
+            : current(begin), end(end), accumulator(0), count(0), overrun(false) {}
+        
+        // не больше 32 бит за раз
+        uint32_t get(int bits) {
+            if (count < bits) refill();
+            if (count < bits) {
+                overrun = true;
+                return 0;
+            }
+            uint32_t value = static_cast<uint32_t>(accumulator & ((1ULL << bits) - 1));
+            accumulator >>= bits;
+            count -= bits;
+            return value;
+        }
+        
+        uint64_t get64() {
+            uint64_t low = get(32);
+            return low | static_cast<uint64_t>(get(32)) << 32;
+        }
+        
+        bool failed() const { return overrun; }
+        
+    private:
+        // добираем накопитель до 56+ бит одним чтением слова, у конца записи - по байту
+        void refill() {
+            if (end - current >= 8) {
+                uint64_t word;
+                std::memcpy(&word, current, 8);  // формат младшими байтами вперёд, как x86 и ARM
+                accumulator |= word << count;
+                current += (63 - count) >> 3;
+                count |= 56;
+                return;
+            }
+            while (count <= 56 && current != end) {
+                accumulator |= static_cast<uint64_t>(*current++) << count;
+                count += 8;
+            }
+        }
+    };
+}
+
+void GameRecord::clear() {
+    seed = 0;
+    winner = 0;
+    fleets[0].clear();
+    fleets[1].clear();
+    shots.clear();
+}
+
+bool GameRecord::replay(Field& first, Field& second, int shotCount) const {
+    Field* fields[2] = {&first, &second};
+    for (int i = 0; i < 2; i++) {
+        fields[i]->reset();
+        for (const ShipRecord& ship : fleets[i]) {
+            if (!fields[i]->placeShip(ship.x, ship.y, ship.size, ship.vertical)) return false;
+        }
+    }
+    
+    // первым стреляет первый игрок, промах передаёт ход
+    int size = first.getSize();
+    int count = shotCount < 0 ? static_cast<int>(shots.size()) : std::min<int>(shotCount, shots.size());
+    int attacker = 0;
+    for (int i = 0; i < count; i++) {
+        Field::AttackResult result = fields[1 - attacker]->attack(shots[i] % size, shots[i] / size);
+        if (result == Field::AttackResult::AlreadyHit || result == Field::AttackResult::Invalid) return false;
+        if (result == Field::AttackResult::Miss) attacker = 1 - attacker;
+    }
+    return true;
+}
+
+GameRecordLayout::GameRecordLayout(const BoardConfig& config) {
+    uint64_t cells = static_cast<uint64_t>(config.size) * config.size;
+    cellBits = bitsFor(cells > 0 ? cells - 1 : 0);
+    coordBits = bitsFor(config.size > 0 ? config.size - 1 : 0);
+    shipCountBits = bitsFor(config.fleet.size());
+    lengthBits = bitsFor(config.maxShipLength());
+    shotCountBits = bitsFor(2 * cells);
+}
+
+// GameRecordWriter
+
+GameRecordWriter::GameRecordWriter(const std::string& path, const BoardConfig& config)
+    : out(path, std::ios::binary | std::ios::trunc), config(config), layout(config),
+      recordCount(0), bytesWritten(0), writeFailed(false) {
+    buffer.reserve(FLUSH_BYTES + 4096);
+    buffer.insert(buffer.end(), MAGIC, MAGIC + 4);
+    buffer.push_back(VERSION);
+    putUint32(buffer, static_cast<uint32_t>(config.size));
+    putUint32(buffer, static_cast<uint32_t>(config.fleet.size()));
+    for (int length : config.fleet) {
+        putUint32(buffer, static_cast<uint32_t>(length));
+    }
+}
+
+GameRecordWriter::~GameRecordWriter() {
+    flush();
+}
+
+void GameRecordWriter::write(const GameRecord& record) {
+    payload.clear();
+    BitWriter bits(payload);
+    bits.put(record.seed, 64);
+    bits.put(static_cast<uint64_t>(record.winner), 2);
+    for (const auto& fleet : record.fleets) {
+        bits.put(fleet.size(), layout.shipCountBits);
+        for (const ShipRecord& ship : fleet) {
+            bits.put(static_cast<uint64_t>(ship.x), layout.coordBits);
+            bits.put(static_cast<uint64_t>(ship.y), layout.coordBits);
+            bits.put(ship.vertical ? 1 : 0, 1);
+            bits.put(static_cast<uint64_t>(ship.size), layout.lengthBits);
+        }
+    }
+    bits.put(record.shots.size(), layout.shotCountBits);
+    for (int cell : record.shots) {
+        bits.put(static_cast<uint64_t>(cell), layout.cellBits);
+    }
+    bits.finish();
+    
+    // длина записи - varint, чтобы читатель мог перешагнуть запись, не разбирая её
+    uint64_t size = payload.size();
+    while (size >= 0x80) {
+        buffer.push_back(static_cast<uint8_t>(size | 0x80));
+        size >>= 7;
+    }
+    buffer.push_back(static_cast<uint8_t>(size));
+    buffer.insert(buffer.end(), payload.begin(), payload.end());
+    recordCount++;
+    
+    if (buffer.size() >= FLUSH_BYTES) {
+        flush();
+    }
+}
+
+bool GameRecordWriter::flush() {
+    if (!buffer.empty()) {
+        if (out.is_open() && out.good()) {
+            out.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+            out.flush();
+        }
+        // в счёт идут только байты, которые поток принял
+        if (out.is_open() && out.good()) bytesWritten += buffer.size();
+        else writeFailed = true;
+    }
+    buffer.clear();
+    return !writeFailed;
+}
+
+// GameRecordReader
+
+GameRecordReader::GameRecordReader()
+    : data(nullptr), length(0), records(nullptr), cursor(nullptr), corrupt(false), layout(config) {}
+
+GameRecordReader::~GameRecordReader() {
+    close();
+}
+
+bool GameRecordReader::open(const std::string& path) {
+    close();
+
+#ifdef _WIN32
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return false;
+    contents.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    data = contents.data();
+    length = contents.size();
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size == 0) {
+        ::close(fd);
+        return false;
+    }
+    length = static_cast<size_t>(info.st_size);
+    void* mapped = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) {
+        length = 0;
+        return false;
+    }
+    madvise(mapped, length, MADV_SEQUENTIAL);
+    data = static_cast<const uint8_t*>(mapped);
+#endif
+
+    // заголовок
+    const size_t fixedHeader = 4 + 1 + 4 + 4;
+    if (length < fixedHeader || std::memcmp(data, MAGIC, 4) != 0 || data[4] != VERSION) {
+        close();
+        return false;
+    }
+    uint32_t size = getUint32(data + 5);
+    uint32_t fleetSize = getUint32(data + 9);
+    if (size == 0 || size > 46340 || fleetSize > (length - fixedHeader) / 4) {
+        close();
+        return false;
+    }
+    config.size = static_cast<int>(size);
+    config.fleet.resize(fleetSize);
+    bool lengthsValid = true;
+    for (uint32_t i = 0; i < fleetSize; i++) {
+        uint32_t shipLength = getUint32(data + fixedHeader + 4 * i);
+        lengthsValid = lengthsValid && shipLength >= 1 && shipLength <= size;
+        config.fleet[i] = lengthsValid ? static_cast<int>(shipLength) : 0;
+    }
+    if (!lengthsValid || !config.isValid()) {
+        close();
+        return false;
+    }
+    layout = GameRecordLayout(config);
+    fleetCounts.assign(config.maxShipLength() + 1, 0);
+    for (int shipLength : config.fleet) fleetCounts[shipLength]++;
+    seenCounts.assign(fleetCounts.size(), 0);
+    records = data + fixedHeader + 4 * static_cast<size_t>(fleetSize);
+    cursor = records;
+    return true;
+}
+
+void GameRecordReader::close() {
+#ifdef _WIN32
+    contents.clear();
+#else
+    if (data) {
+        munmap(const_cast<uint8_t*>(data), length);
+    }
+#endif
+    data = nullptr;
+    length = 0;
+    records = nullptr;
+    cursor = nullptr;
+    corrupt = false;
+}
+
+bool GameRecordReader::next(GameRecord& record) {
+    if (!data) return false;
+    const uint8_t* end = data + length;
+    
+    uint64_t size = 0;
+    int shift = 0;
+    const uint8_t* position = cursor;
+    if (position == end) return false;
+    while (true) {
+        if (position == end || shift > 56) {
+            corrupt = true;
+            return false;
+        }
+        uint8_t byte = *position++;
+        size |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        shift += 7;
+        if (!(byte & 0x80)) break;
+    }
+    if (size > static_cast<uint64_t>(end - position)) {
+        corrupt = true;
+        return false;
+    }
+    
+    BitReader bits(position, position + size);
+    record.seed = bits.get64();
+    record.winner = static_cast<int>(bits.get(2));
+    // записываются только сыгранные партии: каждый флот - ровно флот заголовка
+    bool valid = true;
+    for (auto& fleet : record.fleets) {
+        uint64_t shipCount = bits.get(layout.shipCountBits);
+        if (shipCount != config.fleet.size()) {
+            valid = false;
+            break;
+        }
+        fleet.resize(shipCount);
+        for (ShipRecord& ship : fleet) {
+            ship.x = static_cast<int>(bits.get(layout.coordBits));
+            ship.y = static_cast<int>(bits.get(layout.coordBits));
+            ship.vertical = bits.get(1) != 0;
+            ship.size = static_cast<int>(bits.get(layout.lengthBits));
+            int lastX = ship.vertical ? ship.x : ship.x + ship.size - 1;
+            int lastY = ship.vertical ? ship.y + ship.size - 1 : ship.y;
+            valid = valid && ship.size >= 1 && ship.size < static_cast<int>(fleetCounts.size()) && 
+                    ++seenCounts[ship.size] <= fleetCounts[ship.size] && lastX < config.size && lastY < config.size;
+        }
+        for (const ShipRecord& ship : fleet) {
+            if (ship.size >= 1 && ship.size < static_cast<int>(seenCounts.size())) seenCounts[ship.size] = 0;
+        }
+        if (!valid) break;
+    }
+    if (valid) {
+        // не больше двух выстрелов на клетку и не длиннее самой записи
+        uint64_t cells = static_cast<uint64_t>(config.size) * config.size;
+        uint64_t shotCount = bits.get(layout.shotCountBits);
+        if (shotCount > 2 * cells || shotCount * layout.cellBits > size * 8) {
+            corrupt = true;
+            return false;
+        }
+        record.shots.resize(shotCount);
+        for (int& cell : record.shots) {
+            cell = static_cast<int>(bits.get(layout.cellBits));
+            valid = valid && cell < config.size * config.size;
+        }
+    }
+    if (!valid || bits.failed()) {
+        corrupt = true;
+        return false;
+    }
+    
+    cursor = position + size;
+    return true;
+}
@@ -0,0 +1,125 @@
+#ifndef GAME_RECORD_H
+#define GAME_RECORD_H
+
+#include "BoardConfig.h"
+#include "Ship.h"
+#include "Field.h"
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <fstream>
+
+// запись одной партии: зерно, оба флота и выстрелы по порядку
+// чей выстрел, по записи не хранится: очерёдность восстанавливается по промахам при повторе
+struct GameRecord {
+    uint64_t seed;
+    int winner;                         // 1 или 2, 0 - партия не доиграна
+    std::vector<ShipRecord> fleets[2];  // корабли первого и второго игрока
+    std::vector<int> shots;             // клетки y * size + x обоих игроков; повторы и неверные не пишутся
+    
+    GameRecord() : seed(0), winner(0) {}
+    
+    // очистка без освобождения памяти, запись переиспользуется от партии к партии
+    void clear();
+    
+    // позиция после первых shotCount выстрелов (-1 - конец партии) на полях игроков;
+    // поля должны быть созданы с конфигурацией файла, флоты расставляются заново;
+    // false - корабль не встаёт или выстрел не по правилам (запись испорчена)
+    bool replay(Field& first, Field& second, int shotCount = -1) const;
+};
+
+// ширины полей записи в битах, зависят только от размера поля и флота
+// (размер поля не больше 46340, поэтому любое поле укладывается в 32 бита)
+struct GameRecordLayout {
+    int cellBits;       // номер клетки
+    int coordBits;      // одна координата (корабли пишутся по x и y - без деления при чтении)
+    int shipCountBits;  // число кораблей флота
+    int lengthBits;     // длина корабля
+    int shotCountBits;  // число выстрелов в партии
+    
+    explicit GameRecordLayout(const BoardConfig& config);
+};
+
+// формат файла партий (.sbr)
+//   заголовок: "SBGR", версия (1 байт), размер поля, число кораблей флота и их длины (по 4 байта)
+//   записи подряд: длина записи в байтах (varint), затем биты записи:
+//     зерно (64), победитель (2), для каждого флота - число кораблей и корабли
+//     (x и y начала, вертикальность, длина), число выстрелов и выстрелы (по cellBits)
+// на поле 10x10 выстрел занимает 7 бит, партия целиком - около 142 байт (охотник против охотника)
+
+// дописывающая запись партий; записи копятся в буфере и уходят на диск блоками,
+// так что write в цикле симуляции не обращается к системе и после прогрева не выделяет память
+class GameRecordWriter {
+private:
+    static const size_t FLUSH_BYTES = 1 << 20;
+    
+    std::ofstream out;
+    BoardConfig config;
+    GameRecordLayout layout;
+    std::vector<uint8_t> buffer;   // готовые записи
+    std::vector<uint8_t> payload;  // биты текущей записи
+    long long recordCount;
+    long long bytesWritten;
+    bool writeFailed;              // запись на диск не удалась, записи после неё потеряны
+
+public:
+    // файл создаётся заново; удалось ли - см. isOpen
+    GameRecordWriter(const std::string& path, const BoardConfig& config);
+    ~GameRecordWriter();
+    
+    GameRecordWriter(const GameRecordWriter&) = delete;
+    GameRecordWriter& operator=(const GameRecordWriter&) = delete;
+    
+    bool isOpen() const { return out.is_open() && out.good(); }
+    
+    void write(const GameRecord& record);
+    // false - хотя бы одна запись на диск (в том числе из write) не удалась
+    bool flush();
+    bool failed() const { return writeFailed; }
+    
+    long long getRecordCount() const { return recordCount; }
+    long long getBytesWritten() const { return bytesWritten + static_cast<long long>(buffer.size()); }
+};
+
+// чтение файла партий через отображение в память: записи разбираются прямо
+// из страниц файла без копирования, система читает их вперёд последовательно
+class GameRecordReader {
+private:
+    const uint8_t* data;
+    size_t length;
+    const uint8_t* records;  // первая запись после заголовка
+    const uint8_t* cursor;
+    bool corrupt;            // next остановился на оборванной или испорченной записи
+    BoardConfig config;
+    GameRecordLayout layout;
+    std::vector<int> fleetCounts;  // [длина]: кораблей такой длины во флоте заголовка
+    std::vector<int> seenCounts;   // то же по читаемому флоту записи
+#ifdef _WIN32
+    std::vector<uint8_t> contents;  // без mmap файл читается целиком
+#endif
+
+public:
+    GameRecordReader();
+    ~GameRecordReader();
+    
+    GameRecordReader(const GameRecordReader&) = delete;
+    GameRecordReader& operator=(const GameRecordReader&) = delete;
+    
+    // false - файл не открылся, это не файл партий или поле и флот в заголовке недопустимы
+    bool open(const std::string& path);
+    void close();
+    
+    // следующая партия в record (память record переиспользуется);
+    // false - записи кончились или запись оборвана/испорчена, различает failed;
+    // испорченной считается и запись, чьи флоты не совпадают с флотом заголовка
+    // или корабли и выстрелы выходят за поле
+    bool next(GameRecord& record);
+    bool failed() const { return corrupt; }
+    void rewind() { cursor = records; corrupt = false; }
+    
+    const BoardConfig& getConfig() const { return config; }
+    size_t getFileSize() const { return length; }
+};
+
+#endif
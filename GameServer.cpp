@@ -0,0 +1,456 @@
+#include "GameServer.h"
+#include "Simulation.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstring>
+#include <cerrno>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+    // метка события epoll: дескриптор и поколение соединения на нём; дескриптор,
+    // закрытый и тут же принятый заново в той же пачке событий, получает новое поколение,
+    // и старые события пачки по метке к новому соединению уже не относятся
+    uint64_t eventTag(int fd, uint32_t generation) {
+        return static_cast<uint64_t>(generation) << 32 | static_cast<uint32_t>(fd);
+    }
+    
+    // разбор строки запроса на слова без выделения памяти
+    struct Tokens {
+        static const int MAX_TOKENS = 8;
+        
+        const char* begin[MAX_TOKENS];
+        size_t length[MAX_TOKENS];
+        int count;
+        
+        Tokens(const char* line, size_t size) : count(0) {
+            size_t i = 0;
+            while (i < size && count < MAX_TOKENS) {
+                while (i < size && (line[i] == ' ' || line[i] == '\t' || line[i] == '\r')) i++;
+                if (i == size) break;
+                size_t start = i;
+                while (i < size && line[i] != ' ' && line[i] != '\t' && line[i] != '\r') i++;
+                begin[count] = line + start;
+                length[count] = i - start;
+                count++;
+            }
+        }
+        
+        bool is(int index, const char* word) const {
+            return index < count && length[index] == std::strlen(word) &&
+                   std::memcmp(begin[index], word, length[index]) == 0;
+        }
+        
+        bool number(int index, int& value) const {
+            if (index >= count) return false;
+            auto result = std::from_chars(begin[index], begin[index] + length[index], value);
+            return result.ec == std::errc() && result.ptr == begin[index] + length[index];
+        }
+    };
+}
+
+// LatencyHistogram
+
+LatencyHistogram::LatencyHistogram() {
+    clear();
+}
+
+int LatencyHistogram::bucketFor(uint64_t value) {
+    // значения меньше 8 - каждое в своей корзине, дальше по 8 корзин на степень двойки
+    if (value < (1u << SUB_BITS)) return static_cast<int>(value);
+    int exponent = 63 - __builtin_clzll(value);
+    int mantissa = static_cast<int>((value >> (exponent - SUB_BITS)) & ((1u << SUB_BITS) - 1));
+    return ((exponent - SUB_BITS + 1) << SUB_BITS) + mantissa;
+}
+
+uint64_t LatencyHistogram::bucketUpperBound(int bucket) {
+    if (bucket < (1 << SUB_BITS)) return static_cast<uint64_t>(bucket);
+    int exponent = (bucket >> SUB_BITS) + SUB_BITS - 1;
+    uint64_t mantissa = static_cast<uint64_t>(bucket & ((1 << SUB_BITS) - 1)) + (1u << SUB_BITS);
+    return ((mantissa + 1) << (exponent - SUB_BITS)) - 1;
+}
+
+void LatencyHistogram::record(uint64_t nanoseconds) {
+    counts[bucketFor(nanoseconds)]++;
+    total++;
+    maxValue = std::max(maxValue, nanoseconds);
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other) {
+    for (int i = 0; i < BUCKETS; i++) {
+        counts[i] += other.counts[i];
+    }
+    total += other.total;
+    maxValue = std::max(maxValue, other.maxValue);
+}
+
+void LatencyHistogram::clear() {
+    counts.fill(0);
+    total = 0;
+    maxValue = 0;
+}
+
+uint64_t LatencyHistogram::percentile(double fraction) const {
+    if (total == 0) return 0;
+    uint64_t rank = std::min(total, static_cast<uint64_t>(fraction * total) + 1);
+    uint64_t seen = 0;
+    for (int i = 0; i < BUCKETS; i++) {
+        seen += counts[i];
+        if (seen >= rank) return std::min(bucketUpperBound(i), maxValue);
+    }
+    return maxValue;
+}
+
+// GameServer
+
+struct GameServer::Connection {
+    int fd;
+    uint32_t generation;  // старшая половина метки событий epoll этого соединения
+    bool writing;      // ждём готовности к записи (EPOLLOUT включён)
+    bool closing;      // закрыть, как только уйдёт ответ
+    std::string input;
+    std::string output;
+    size_t outputSent;
+    std::unique_ptr<GameSession> session;
+    
+    Connection(int fd, uint32_t generation) 
+        : fd(fd), generation(generation), writing(false), closing(false), outputSent(0) {}
+};
+
+struct GameServer::Worker {
+    int index;
+    int epollFd = -1;
+    int listenFd = -1;
+    int stopFd = -1;
+    std::thread thread;
+    std::vector<std::unique_ptr<Connection>> connections;  // по номеру дескриптора
+    uint32_t nextGeneration = 1;                            // 0 - слушающий сокет и eventfd
+    Rng rng;                                                // зёрна сессий потока
+    Stats stats;
+    
+    explicit Worker(int index) : index(index) {}
+    
+    ~Worker() {
+        for (auto& connection : connections) {
+            if (connection) ::close(connection->fd);
+        }
+        if (listenFd >= 0) ::close(listenFd);
+        if (stopFd >= 0) ::close(stopFd);
+        if (epollFd >= 0) ::close(epollFd);
+    }
+};
+
+GameServer::GameServer(const Options& options) : options(options), port(options.port) {}
+
+GameServer::~GameServer() {
+    stop();
+    wait();
+}
+
+bool GameServer::openListener(Worker& worker) {
+    worker.listenFd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (worker.listenFd < 0) return false;
+    
+    int enable = 1;
+    setsockopt(worker.listenFd, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+    setsockopt(worker.listenFd, SOL_SOCKET, SO_REUSEPORT, &enable, sizeof(enable));
+    
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(static_cast<uint16_t>(port));
+    if (inet_pton(AF_INET, options.host.c_str(), &address.sin_addr) != 1) {
+        errno = EINVAL;
+        return false;
+    }
+    if (bind(worker.listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) return false;
+    if (listen(worker.listenFd, SOMAXCONN) != 0) return false;
+    
+    // порт 0: свободный порт выбирает первый поток, остальные садятся на него же
+    if (port == 0) {
+        socklen_t length = sizeof(address);
+        getsockname(worker.listenFd, reinterpret_cast<sockaddr*>(&address), &length);
+        port = ntohs(address.sin_port);
+    }
+    return true;
+}
+
+bool GameServer::start() {
+    int threads = options.threads > 0 ? options.threads : WorkStealingPool::defaultThreadCount();
+    
+    for (int i = 0; i < threads; i++) {
+        auto worker = std::make_unique<Worker>(i);
+        worker->rng = Rng::forStream(options.seed, static_cast<uint64_t>(i));
+        worker->epollFd = epoll_create1(EPOLL_CLOEXEC);
+        worker->stopFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (worker->epollFd < 0 || worker->stopFd < 0 || !openListener(*worker)) {
+            error = std::string("сокет на ") + options.host + ":" + std::to_string(port) + ": " + std::strerror(errno);
+            workers.clear();
+            return false;
+        }
+        
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.u64 = eventTag(worker->listenFd, 0);
+        epoll_ctl(worker->epollFd, EPOLL_CTL_ADD, worker->listenFd, &event);
+        event.data.u64 = eventTag(worker->stopFd, 0);
+        epoll_ctl(worker->epollFd, EPOLL_CTL_ADD, worker->stopFd, &event);
+        workers.push_back(std::move(worker));
+    }
+    
+    for (auto& worker : workers) {
+        Worker* current = worker.get();
+        current->thread = std::thread([this, current] { workerLoop(*current); });
+    }
+    return true;
+}
+
+void GameServer::stop() {
+    // write в eventfd безопасен и из обработчика сигнала
+    for (auto& worker : workers) {
+        uint64_t one = 1;
+        ssize_t written = ::write(worker->stopFd, &one, sizeof(one));
+        (void)written;
+    }
+}
+
+void GameServer::wait() {
+    for (auto& worker : workers) {
+        if (worker->thread.joinable()) worker->thread.join();
+    }
+}
+
+GameServer::Stats GameServer::getStats() const {
+    Stats total;
+    for (const auto& worker : workers) {
+        total.connections += worker->stats.connections;
+        total.games += worker->stats.games;
+        total.requests += worker->stats.requests;
+        total.latency.merge(worker->stats.latency);
+    }
+    return total;
+}
+
+void GameServer::workerLoop(Worker& worker) {
+    epoll_event events[MAX_EVENTS];
+    
+    while (true) {
+        int count = epoll_wait(worker.epollFd, events, MAX_EVENTS, -1);
+        if (count < 0) {
+            if (errno == EINTR) continue;
+            return;
+        }
+        
+        for (int i = 0; i < count; i++) {
+            int fd = static_cast<int>(static_cast<uint32_t>(events[i].data.u64));
+            uint32_t generation = static_cast<uint32_t>(events[i].data.u64 >> 32);
+            if (fd == worker.stopFd) return;
+            if (fd == worker.listenFd) {
+                acceptConnections(worker);
+                continue;
+            }
+            
+            // соединение могло закрыться раньше в этой же пачке событий,
+            // а его дескриптор - уже достаться новому соединению
+            auto alive = [&worker, fd, generation] {
+                return fd < static_cast<int>(worker.connections.size()) && worker.connections[fd] &&
+                       worker.connections[fd]->generation == generation;
+            };
+            if (!alive()) continue;
+            Connection& connection = *worker.connections[fd];
+            
+            if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+                closeConnection(worker, connection);
+                continue;
+            }
+            if (events[i].events & EPOLLIN) {
+                readConnection(worker, connection);
+                if (!alive()) continue;
+            }
+            if (events[i].events & EPOLLOUT) {
+                writeConnection(worker, connection);
+            }
+        }
+    }
+}
+
+void GameServer::acceptConnections(Worker& worker) {
+    while (true) {
+        int fd = accept4(worker.listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) return;  // EAGAIN - очередь разобрана; EMFILE - не хватает дескрипторов, ждём
+        
+        // ответы короткие и идут сразу: без Нейгла они не ждут подтверждения прошлых пакетов
+        int enable = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+        
+        if (fd >= static_cast<int>(worker.connections.size())) {
+            worker.connections.resize(fd + 1);
+        }
+        uint32_t generation = worker.nextGeneration++;
+        if (worker.nextGeneration == 0) worker.nextGeneration = 1;
+        worker.connections[fd] = std::make_unique<Connection>(fd, generation);
+        
+        epoll_event event{};
+        event.events = EPOLLIN | EPOLLRDHUP;
+        event.data.u64 = eventTag(fd, generation);
+        epoll_ctl(worker.epollFd, EPOLL_CTL_ADD, fd, &event);
+        worker.stats.connections++;
+    }
+}
+
+void GameServer::readConnection(Worker& worker, Connection& connection) {
+    char buffer[4096];
+    bool peerClosed = false;
+    
+    while (true) {
+        ssize_t received = ::read(connection.fd, buffer, sizeof(buffer));
+        if (received > 0) {
+            connection.input.append(buffer, static_cast<size_t>(received));
+            if (static_cast<size_t>(received) < sizeof(buffer)) break;
+            continue;
+        }
+        if (received < 0 && errno == EINTR) continue;
+        if (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+        peerClosed = true;  // 0 - клиент закрыл соединение, иначе ошибка
+        break;
+    }
+    
+    // все полные строки; хвост без перевода строки ждёт продолжения
+    size_t start = 0;
+    while (!connection.closing) {
+        size_t end = connection.input.find('\n', start);
+        if (end == std::string::npos) break;
+        handleRequest(worker, connection, connection.input.data() + start, end - start);
+        start = end + 1;
+    }
+    connection.input.erase(0, start);
+    
+    if (connection.input.size() > MAX_LINE) {
+        connection.output += "ERR line\n";
+        connection.closing = true;
+    }
+    // клиент ушёл: досылаем готовые ответы и закрываем
+    if (peerClosed) connection.closing = true;
+    writeConnection(worker, connection);
+}
+
+void GameServer::writeConnection(Worker& worker, Connection& connection) {
+    while (connection.outputSent < connection.output.size()) {
+        ssize_t sent = ::send(connection.fd, connection.output.data() + connection.outputSent,
+                              connection.output.size() - connection.outputSent, MSG_NOSIGNAL);
+        if (sent > 0) {
+            connection.outputSent += static_cast<size_t>(sent);
+            continue;
+        }
+        if (sent < 0 && errno == EINTR) continue;
+        if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            // сокет полон: дописываем, когда освободится
+            if (!connection.writing) {
+                epoll_event event{};
+                event.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP;
+                event.data.u64 = eventTag(connection.fd, connection.generation);
+                epoll_ctl(worker.epollFd, EPOLL_CTL_MOD, connection.fd, &event);
+                connection.writing = true;
+            }
+            return;
+        }
+        closeConnection(worker, connection);
+        return;
+    }
+    
+    connection.output.clear();
+    connection.outputSent = 0;
+    if (connection.closing) {
+        closeConnection(worker, connection);
+        return;
+    }
+    if (connection.writing) {
+        epoll_event event{};
+        event.events = EPOLLIN | EPOLLRDHUP;
+        event.data.u64 = eventTag(connection.fd, connection.generation);
+        epoll_ctl(worker.epollFd, EPOLL_CTL_MOD, connection.fd, &event);
+        connection.writing = false;
+    }
+}
+
+void GameServer::closeConnection(Worker& worker, Connection& connection) {
+    int fd = connection.fd;
+    epoll_ctl(worker.epollFd, EPOLL_CTL_DEL, fd, nullptr);
+    ::close(fd);
+    worker.connections[fd].reset();
+}
+
+void GameServer::handleRequest(Worker& worker, Connection& connection, const char* line, size_t length) {
+    auto start = std::chrono::steady_clock::now();
+    Tokens tokens(line, length);
+    std::string& out = connection.output;
+    GameSession* session = connection.session.get();
+    int x, y, size;
+    
+    if (tokens.count == 0) {
+        return;
+    } else if (tokens.is(0, "NEW")) {
+        TargetingStrategy strategy = options.strategy;
+        if (tokens.count > 1 && !parseStrategy(std::string(tokens.begin[1], tokens.length[1]), strategy)) {
+            out += "ERR strategy";
+        } else {
+            connection.session = GameSession::create(options.config, strategy, worker.rng());
+            if (!connection.session) {
+                // флот компьютера не помещается на поле
+                out += "ERR fleet";
+            } else {
+                worker.stats.games++;
+                out += "OK ";
+                GameSession::appendNumber(out, options.config.size);
+                for (int shipLength : options.config.fleet) {
+                    out += ' ';
+                    GameSession::appendNumber(out, shipLength);
+                }
+            }
+        }
+    } else if (tokens.is(0, "PLACE")) {
+        bool vertical = tokens.is(4, "v");
+        if (session && tokens.number(1, x) && tokens.number(2, y) && tokens.number(3, size) &&
+            (vertical || tokens.is(4, "h")) && session->placeShip(x, y, size, vertical)) {
+            out += "OK";
+        } else {
+            out += "ERR place";
+        }
+    } else if (tokens.is(0, "AUTO")) {
+        if (session && session->getPhase() == GameSession::Phase::Placing) {
+            out += session->placeAllShips() ? "OK" : "ERR fleet";
+        } else {
+            out += "ERR place";
+        }
+    } else if (tokens.is(0, "START")) {
+        out += session && session->start() ? "OK" : "ERR fleet";
+    } else if (tokens.is(0, "SHOT")) {
+        if (!session || !tokens.number(1, x) || !tokens.number(2, y) || !session->shoot(x, y, out)) {
+            out += "ERR shot";
+        }
+    } else if (tokens.is(0, "STATS")) {
+        out += "OK ";
+        GameSession::appendNumber(out, static_cast<long long>(worker.stats.latency.count()));
+        out += ' ';
+        GameSession::appendNumber(out, static_cast<long long>(worker.stats.latency.percentile(0.5)));
+        out += ' ';
+        GameSession::appendNumber(out, static_cast<long long>(worker.stats.latency.percentile(0.99)));
+    } else if (tokens.is(0, "QUIT")) {
+        out += "BYE";
+        connection.closing = true;
+    } else {
+        out += "ERR command";
+    }
+    out += '\n';
+    
+    worker.stats.requests++;
+    worker.stats.latency.record(static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count()));
+}
@@ -0,0 +1,114 @@
+#ifndef GAME_SERVER_H
+#define GAME_SERVER_H
+
+#include "GameSession.h"
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+// гистограмма задержек в наносекундах: 8 корзин на каждую степень двойки (точность ~12%);
+// запись - пара сдвигов без выделения памяти, гистограммы потоков складываются
+class LatencyHistogram {
+private:
+    static const int SUB_BITS = 3;
+    static const int BUCKETS = 64 << SUB_BITS;
+    
+    std::array<uint64_t, BUCKETS> counts;
+    uint64_t total;
+    uint64_t maxValue;
+    
+    static int bucketFor(uint64_t value);
+    static uint64_t bucketUpperBound(int bucket);
+
+public:
+    LatencyHistogram();
+    
+    void record(uint64_t nanoseconds);
+    void merge(const LatencyHistogram& other);
+    void clear();
+    
+    // верхняя граница корзины, в которую попал перцентиль; fraction от 0 до 1
+    uint64_t percentile(double fraction) const;
+    uint64_t count() const { return total; }
+    uint64_t max() const { return maxValue; }
+};
+
+// сервер партий по TCP: несколько потоков, у каждого свой epoll и свой слушающий сокет
+// на общем порту (SO_REUSEPORT) - ядро само раскладывает соединения по потокам,
+// и поток ведёт свои соединения без блокировок
+//
+// протокол строковый, запрос и ответ - по одной строке, координаты с нуля:
+//   NEW [hunt|density]  -> OK размер длины_флота...   новая партия (прежняя бросается)
+//                        | ERR fleet                  флот компьютера не помещается на поле
+//   PLACE x y длина h|v -> OK | ERR place
+//   AUTO                -> OK | ERR fleet             расставить весь флот
+//   START               -> OK | ERR fleet
+//   SHOT x y            -> см. GameSession::shoot     | ERR shot
+//   STATS               -> OK запросов p50_нс p99_нс  задержки обработки в потоке соединения
+//   QUIT                -> BYE, соединение закрывается
+// любая другая строка - ERR command
+class GameServer {
+public:
+    struct Options {
+        std::string host = "127.0.0.1";
+        int port = 7777;        // 0 - свободный порт, см. getPort
+        int threads = 1;        // 0 - по числу ядер машины
+        BoardConfig config;
+        TargetingStrategy strategy = TargetingStrategy::HuntTarget;
+        uint64_t seed = 12345;
+    };
+    
+    struct Stats {
+        long long connections = 0;  // принято соединений
+        long long games = 0;        // начато партий
+        long long requests = 0;
+        LatencyHistogram latency;   // время обработки запроса, от разбора строки до готового ответа
+    };
+
+private:
+    struct Connection;
+    struct Worker;
+    
+    // длиннее строка запроса не бывает: соединение с такой строкой закрывается
+    static const size_t MAX_LINE = 256;
+    static const int MAX_EVENTS = 256;
+    
+    Options options;
+    int port;
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::string error;
+    
+    bool openListener(Worker& worker);
+    void workerLoop(Worker& worker);
+    void acceptConnections(Worker& worker);
+    void readConnection(Worker& worker, Connection& connection);
+    void writeConnection(Worker& worker, Connection& connection);
+    void closeConnection(Worker& worker, Connection& connection);
+    void handleRequest(Worker& worker, Connection& connection, const char* line, size_t length);
+
+public:
+    explicit GameServer(const Options& options);
+    ~GameServer();
+    
+    GameServer(const GameServer&) = delete;
+    GameServer& operator=(const GameServer&) = delete;
+    
+    // сокеты и потоки; false - не удалось, причина в getError
+    bool start();
+    // можно звать из любого потока и из обработчика сигнала
+    void stop();
+    // ждать остановки потоков
+    void wait();
+    
+    int getPort() const { return port; }
+    int getThreadCount() const { return static_cast<int>(workers.size()); }
+    const std::string& getError() const { return error; }
+    
+    // сумма по потокам; точна после wait
+    Stats getStats() const;
+};
+
+#endif
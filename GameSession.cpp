@@ -0,0 +1,372 @@
+#include "GameSession.h"
+#include "FleetGenerator.h"
+#include <algorithm>
+#include <charconv>
+
+namespace {
+    bool testBit(const uint64_t* bits, int index) {
+        return (bits[index >> 6] >> (index & 63)) & 1;
+    }
+    
+    void setBit(uint64_t* bits, int index) {
+        bits[index >> 6] |= 1ULL << (index & 63);
+    }
+    
+    uint16_t encodeShip(int x, int y, bool vertical) {
+        return static_cast<uint16_t>(x | y << 4 | (vertical ? 1 << 8 : 0));
+    }
+    
+    void decodeShip(uint16_t code, int& x, int& y, bool& vertical) {
+        x = code & 15;
+        y = (code >> 4) & 15;
+        vertical = (code >> 8) & 1;
+    }
+    
+}
+
+// GameSession
+
+void GameSession::appendNumber(std::string& out, long long value) {
+    char digits[24];
+    auto end = std::to_chars(digits, digits + sizeof(digits), value).ptr;
+    out.append(digits, end);
+}
+
+void GameSession::appendResult(std::string& out, Field::AttackResult result) {
+    switch (result) {
+        case Field::AttackResult::Miss:      out += "MISS"; break;
+        case Field::AttackResult::Hit:       out += "HIT"; break;
+        case Field::AttackResult::Destroyed: out += "SUNK"; break;
+        default:                             out += "REPEAT"; break;
+    }
+}
+
+void GameSession::appendMove(std::string& out, int x, int y, Field::AttackResult result) {
+    out += ' ';
+    appendNumber(out, x);
+    out += ' ';
+    appendNumber(out, y);
+    out += ' ';
+    appendResult(out, result);
+}
+
+std::unique_ptr<GameSession> GameSession::create(const BoardConfig& config, TargetingStrategy strategy, uint64_t seed) {
+    std::unique_ptr<GameSession> session;
+    if (CompactGameSession::supports(config, strategy)) {
+        session = std::make_unique<CompactGameSession>(config, seed);
+    } else {
+        session = std::make_unique<EngineGameSession>(config, strategy, seed);
+    }
+    if (!session->hasComputerFleet()) return nullptr;
+    return session;
+}
+
+// EngineGameSession
+
+EngineGameSession::EngineGameSession(const BoardConfig& config, TargetingStrategy strategy, uint64_t seed)
+    : rng(seed), field(config), computer("Компьютер", strategy, config), phase(Phase::Placing),
+      shipsLeft(config.maxShipLength() + 1, 0), shipsToPlace(static_cast<int>(config.fleet.size())),
+      computerFleet(false) {
+    field.setRng(&rng);
+    computer.setRng(&rng);
+    computerFleet = computer.placeShips();
+    for (int length : config.fleet) {
+        shipsLeft[length]++;
+    }
+}
+
+bool EngineGameSession::placeShip(int x, int y, int length, bool vertical) {
+    if (phase != Phase::Placing || length <= 0 || length >= static_cast<int>(shipsLeft.size()) ||
+        shipsLeft[length] == 0) {
+        return false;
+    }
+    if (!field.placeShip(x, y, length, vertical)) return false;
+    shipsLeft[length]--;
+    shipsToPlace--;
+    return true;
+}
+
+bool EngineGameSession::placeAllShips() {
+    if (phase != Phase::Placing) return false;
+    field.reset();
+    if (!field.placeAllShipsAuto()) {
+        // частичную расстановку не оставляем: игрок расставляет заново с пустого поля
+        field.reset();
+        std::fill(shipsLeft.begin(), shipsLeft.end(), 0);
+        for (int length : field.getFleet()) {
+            shipsLeft[length]++;
+        }
+        shipsToPlace = static_cast<int>(field.getFleet().size());
+        return false;
+    }
+    std::fill(shipsLeft.begin(), shipsLeft.end(), 0);
+    shipsToPlace = 0;
+    return true;
+}
+
+bool EngineGameSession::start() {
+    if (phase != Phase::Placing || shipsToPlace > 0) return false;
+    phase = Phase::Playing;
+    return true;
+}
+
+bool EngineGameSession::shoot(int x, int y, std::string& out) {
+    if (phase != Phase::Playing) return false;
+    
+    Field::AttackResult result = computer.getField().attack(x, y);
+    if (result == Field::AttackResult::Invalid) return false;
+    
+    if (result == Field::AttackResult::Destroyed && computer.hasLost()) {
+        phase = Phase::Finished;
+        out += "WIN";
+        return true;
+    }
+    appendResult(out, result);
+    if (result != Field::AttackResult::Miss) return true;
+    
+    // ход компьютера до его промаха
+    while (true) {
+        std::pair<int, int> move = computer.makeMove();
+        Field::AttackResult answer = field.attack(move.first, move.second);
+        computer.onAttackResult(move.first, move.second, answer);
+        appendMove(out, move.first, move.second, answer);
+        
+        if (field.allShipsDestroyed()) {
+            phase = Phase::Finished;
+            out += " LOSE";
+            break;
+        }
+        if (answer == Field::AttackResult::Miss || answer == Field::AttackResult::Invalid) break;
+    }
+    return true;
+}
+
+// CompactGameSession
+
+bool CompactGameSession::supports(const BoardConfig& config, TargetingStrategy strategy) {
+    if (strategy != TargetingStrategy::HuntTarget || config.size < 1 || config.size > MAX_SIZE ||
+        config.fleet.size() > static_cast<size_t>(MAX_SHIPS)) {
+        return false;
+    }
+    return std::all_of(config.fleet.begin(), config.fleet.end(),
+                       [](int length) { return length >= 1 && length <= MAX_SHIP_LENGTH; });
+}
+
+CompactGameSession::CompactGameSession(const BoardConfig& config, uint64_t seed)
+    : config(&config), boards(), rngState(seed), phase(Phase::Placing), computerShots(), 
+      priorityCells(), priorityCount(0) {
+    placeAll(boards[1]);
+}
+
+uint64_t CompactGameSession::nextRandom() {
+    uint64_t z = (rngState += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+int CompactGameSession::randomBelow(int n) {
+    return static_cast<int>((nextRandom() >> 32) * static_cast<uint64_t>(n) >> 32);
+}
+
+bool CompactGameSession::canPlace(const Board& board, int x, int y, int length, bool vertical) const {
+    int size = config->size;
+    int endX = vertical ? x : x + length - 1;
+    int endY = vertical ? y + length - 1 : y;
+    if (x < 0 || y < 0 || endX >= size || endY >= size) return false;
+    
+    // ни палубы, ни соседей (с диагоналями) у чужих кораблей
+    for (int row = std::max(y - 1, 0); row <= std::min(endY + 1, size - 1); row++) {
+        for (int col = std::max(x - 1, 0); col <= std::min(endX + 1, size - 1); col++) {
+            if (testBit(board.ships, cell(col, row))) return false;
+        }
+    }
+    return true;
+}
+
+void CompactGameSession::place(Board& board, int ship, int x, int y, bool vertical) {
+    for (int i = 0; i < config->fleet[ship]; i++) {
+        setBit(board.ships, vertical ? cell(x, y + i) : cell(x + i, y));
+    }
+    board.shipCodes[ship] = encodeShip(x, y, vertical);
+    board.placedMask |= static_cast<uint16_t>(1u << ship);
+}
+
+bool CompactGameSession::placeAll(Board& board) {
+    board = Board();
+    const std::vector<int>& fleet = config->fleet;
+    
+    // генератор пишет положения по убыванию длин: корабль с номером во флоте - первый
+    // ещё не поставленный той же длины
+    // рабочие буферы генератора живут в потоке и в партию не входят
+    Rng rng(nextRandom());
+    FleetGenerator& generator = FleetGenerator::forThread(config->size, config->fleet);
+    if (!generator.generate(rng)) return false;
+    for (const Placement& placement : generator.getLayout()) {
+        for (size_t ship = 0; ship < fleet.size(); ship++) {
+            if (fleet[ship] == placement.size && !((board.placedMask >> ship) & 1)) {
+                place(board, static_cast<int>(ship), placement.x, placement.y, placement.vertical);
+                break;
+            }
+        }
+    }
+    return true;
+}
+
+int CompactGameSession::shipAt(const Board& board, int x, int y) const {
+    for (size_t ship = 0; ship < config->fleet.size(); ship++) {
+        if (!((board.placedMask >> ship) & 1)) continue;
+        int shipX, shipY;
+        bool vertical;
+        decodeShip(board.shipCodes[ship], shipX, shipY, vertical);
+        int offset = vertical ? y - shipY : x - shipX;
+        if ((vertical ? x == shipX : y == shipY) && offset >= 0 && offset < config->fleet[ship]) {
+            return static_cast<int>(ship);
+        }
+    }
+    return -1;
+}
+
+Field::AttackResult CompactGameSession::attack(Board& board, int x, int y) {
+    int size = config->size;
+    if (x < 0 || y < 0 || x >= size || y >= size) return Field::AttackResult::Invalid;
+    
+    int index = cell(x, y);
+    if (testBit(board.hits, index) || testBit(board.misses, index)) return Field::AttackResult::AlreadyHit;
+    if (!testBit(board.ships, index)) {
+        setBit(board.misses, index);
+        return Field::AttackResult::Miss;
+    }
+    setBit(board.hits, index);
+    
+    int ship = shipAt(board, x, y);
+    int shipX, shipY;
+    bool vertical;
+    decodeShip(board.shipCodes[ship], shipX, shipY, vertical);
+    int length = config->fleet[ship];
+    for (int i = 0; i < length; i++) {
+        if (!testBit(board.hits, vertical ? cell(shipX, shipY + i) : cell(shipX + i, shipY))) {
+            return Field::AttackResult::Hit;
+        }
+    }
+    
+    // потоплен: клетки вокруг открываются промахами, как на Field
+    board.sunkMask |= static_cast<uint16_t>(1u << ship);
+    int endX = vertical ? shipX : shipX + length - 1;
+    int endY = vertical ? shipY + length - 1 : shipY;
+    for (int row = std::max(shipY - 1, 0); row <= std::min(endY + 1, size - 1); row++) {
+        for (int col = std::max(shipX - 1, 0); col <= std::min(endX + 1, size - 1); col++) {
+            if (!testBit(board.ships, cell(col, row))) setBit(board.misses, cell(col, row));
+        }
+    }
+    return Field::AttackResult::Destroyed;
+}
+
+bool CompactGameSession::allSunk(const Board& board) const {
+    return board.sunkMask == board.placedMask;
+}
+
+std::pair<int, int> CompactGameSession::computerMove() {
+    int size = config->size;
+    int target;
+    if (priorityCount > 0) {
+        // есть соседи попаданий - добиваем корабль, последний добавленный первым
+        target = priorityCells[--priorityCount];
+    } else {
+        // случайная клетка, по которой компьютер ещё не стрелял: k-я по порядку
+        int open = 0;
+        for (int i = 0; i < size * size; i++) {
+            open += !testBit(computerShots, i);
+        }
+        if (open == 0) return {-1, -1};
+        int skip = randomBelow(open);
+        target = 0;
+        for (int i = 0; i < size * size; i++) {
+            if (testBit(computerShots, i)) continue;
+            target = i;
+            if (skip-- == 0) break;
+        }
+    }
+    setBit(computerShots, target);
+    return {target % size, target / size};
+}
+
+void CompactGameSession::onComputerResult(int x, int y, Field::AttackResult result) {
+    if (result == Field::AttackResult::Destroyed) {
+        priorityCount = 0;
+        return;
+    }
+    if (result != Field::AttackResult::Hit) return;
+    
+    // соседи попадания в том же порядке, что у ComputerPlayer::addPriorityCells
+    int size = config->size;
+    const int dx[4] = {-1, 1, 0, 0};
+    const int dy[4] = {0, 0, -1, 1};
+    for (int d = 0; d < 4; d++) {
+        int nx = x + dx[d], ny = y + dy[d];
+        if (nx < 0 || ny < 0 || nx >= size || ny >= size) continue;
+        int neighbor = cell(nx, ny);
+        if (testBit(computerShots, neighbor) ||
+            std::find(priorityCells, priorityCells + priorityCount, neighbor) != priorityCells + priorityCount) {
+            continue;
+        }
+        priorityCells[priorityCount++] = static_cast<uint8_t>(neighbor);
+    }
+}
+
+bool CompactGameSession::placeShip(int x, int y, int length, bool vertical) {
+    if (phase != Phase::Placing) return false;
+    const std::vector<int>& fleet = config->fleet;
+    Board& board = boards[0];
+    for (size_t ship = 0; ship < fleet.size(); ship++) {
+        if (fleet[ship] != length || ((board.placedMask >> ship) & 1)) continue;
+        if (!canPlace(board, x, y, length, vertical)) return false;
+        place(board, static_cast<int>(ship), x, y, vertical);
+        return true;
+    }
+    return false;
+}
+
+bool CompactGameSession::placeAllShips() {
+    if (phase != Phase::Placing) return false;
+    // placeAll ставит флот целиком или оставляет доску пустой
+    return placeAll(boards[0]);
+}
+
+bool CompactGameSession::start() {
+    if (phase != Phase::Placing || !fleetPlaced(boards[0]) || !fleetPlaced(boards[1])) {
+        return false;
+    }
+    phase = Phase::Playing;
+    return true;
+}
+
+bool CompactGameSession::shoot(int x, int y, std::string& out) {
+    if (phase != Phase::Playing) return false;
+    
+    Field::AttackResult result = attack(boards[1], x, y);
+    if (result == Field::AttackResult::Invalid) return false;
+    
+    if (result == Field::AttackResult::Destroyed && allSunk(boards[1])) {
+        phase = Phase::Finished;
+        out += "WIN";
+        return true;
+    }
+    appendResult(out, result);
+    if (result != Field::AttackResult::Miss) return true;
+    
+    while (true) {
+        std::pair<int, int> move = computerMove();
+        Field::AttackResult answer = attack(boards[0], move.first, move.second);
+        onComputerResult(move.first, move.second, answer);
+        appendMove(out, move.first, move.second, answer);
+        
+        if (allSunk(boards[0])) {
+            phase = Phase::Finished;
+            out += " LOSE";
+            break;
+        }
+        if (answer == Field::AttackResult::Miss || answer == Field::AttackResult::Invalid) break;
+    }
+    return true;
+}
@@ -0,0 +1,136 @@
+#ifndef GAME_SESSION_H
+#define GAME_SESSION_H
+
+#include "Player.h"
+#include "BoardConfig.h"
+#include "Random.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// партия удалённого игрока против компьютера, ведётся по запросам:
+// сначала расстановка (по кораблю или автоматически), затем выстрелы;
+// на промах игрока компьютер сразу делает свои ходы
+class GameSession {
+public:
+    enum class Phase { Placing, Playing, Finished };
+    
+    // число в ответ протокола без выделения памяти под промежуточную строку (и для сервера)
+    static void appendNumber(std::string& out, long long value);
+
+protected:
+    static void appendResult(std::string& out, Field::AttackResult result);
+    static void appendMove(std::string& out, int x, int y, Field::AttackResult result);
+
+public:
+    virtual ~GameSession() = default;
+    
+    // false - такого корабля во флоте не осталось или он не встаёт
+    virtual bool placeShip(int x, int y, int length, bool vertical) = 0;
+    // false - флот не поместился на поле, расставлять придётся заново
+    virtual bool placeAllShips() = 0;
+    // false - расставлен не весь флот
+    virtual bool start() = 0;
+    
+    // выстрел игрока; при промахе - ответные выстрелы компьютера.
+    // ответ дописывается в out: "HIT", "SUNK", "WIN", "REPEAT" или
+    // "MISS" и ходы компьютера "x y MISS|HIT|SUNK", в конце "LOSE", если компьютер победил;
+    // false - партия не идёт или клетка вне поля (out не меняется)
+    virtual bool shoot(int x, int y, std::string& out) = 0;
+    
+    virtual Phase getPhase() const = 0;
+    // false - флот компьютера не поместился на поле, партию не начать
+    virtual bool hasComputerFleet() const = 0;
+    
+    // компактная партия, если её позволяют поле, флот и стратегия, иначе - на объектах движка;
+    // nullptr - флот компьютера не помещается на поле; config должен жить дольше партии
+    static std::unique_ptr<GameSession> create(const BoardConfig& config, TargetingStrategy strategy, uint64_t seed);
+};
+
+// партия на объектах движка: любое поле и любая стратегия, но несколько килобайт на партию
+class EngineGameSession : public GameSession {
+private:
+    Rng rng;                     // свой генератор: ходы партии не зависят от соседей по потоку
+    Field field;                 // поле удалённого игрока
+    ComputerPlayer computer;
+    Phase phase;
+    std::vector<int> shipsLeft;  // сколько кораблей каждой длины осталось расставить
+    int shipsToPlace;
+    bool computerFleet;          // флот компьютера поместился
+
+public:
+    EngineGameSession(const BoardConfig& config, TargetingStrategy strategy, uint64_t seed);
+    
+    EngineGameSession(const EngineGameSession&) = delete;
+    EngineGameSession& operator=(const EngineGameSession&) = delete;
+    
+    bool placeShip(int x, int y, int length, bool vertical) override;
+    bool placeAllShips() override;
+    bool start() override;
+    bool shoot(int x, int y, std::string& out) override;
+    Phase getPhase() const override { return phase; }
+    bool hasComputerFleet() const override { return computerFleet; }
+};
+
+// партия в паре сотен байт без выделения памяти: обе доски - по 128 бит на палубы,
+// попадания и промахи, корабли - по 16 бит на номер во флоте, генератор - одно слово;
+// компьютер охотится так же, как ComputerPlayer: стек соседей попаданий на байтах клеток
+// и свои выстрелы отдельной доской (клетки вокруг потопленного он, как и там, не вычёркивает)
+// поле до 11x11, флот до 16 кораблей не длиннее 15 клеток, стратегия - только охота
+class CompactGameSession : public GameSession {
+public:
+    static const int MAX_SIZE = 11;  // 121 клетка - два слова на доску
+    static const int MAX_SHIPS = 16;
+    static const int MAX_SHIP_LENGTH = 15;
+    // соседей недобитого корабля не больше 3 * длина + 2, длина - не больше стороны поля
+    static const int MAX_PRIORITY_CELLS = 3 * MAX_SIZE + 2;
+    
+    static bool supports(const BoardConfig& config, TargetingStrategy strategy);
+
+private:
+    struct Board {
+        uint64_t ships[2];
+        uint64_t hits[2];
+        uint64_t misses[2];             // промахи и открытые клетки вокруг потопленных
+        uint16_t shipCodes[MAX_SHIPS];  // по номеру во флоте: x (4 бита), y (4 бита), вертикальность
+        uint16_t placedMask;            // какие корабли флота стоят на доске
+        uint16_t sunkMask;
+    };
+    
+    const BoardConfig* config;
+    Board boards[2];                    // 0 - удалённый игрок, 1 - компьютер
+    uint64_t rngState;                  // splitmix64
+    Phase phase;
+    
+    // охота компьютера, как у ComputerPlayer
+    uint64_t computerShots[2];                    // клетки, по которым компьютер уже стрелял
+    uint8_t priorityCells[MAX_PRIORITY_CELLS];    // соседи попаданий, берутся с конца
+    uint8_t priorityCount;
+    
+    uint64_t nextRandom();
+    int randomBelow(int n);
+    
+    int cell(int x, int y) const { return y * config->size + x; }
+    bool canPlace(const Board& board, int x, int y, int length, bool vertical) const;
+    void place(Board& board, int ship, int x, int y, bool vertical);
+    bool placeAll(Board& board);
+    int shipAt(const Board& board, int x, int y) const;
+    Field::AttackResult attack(Board& board, int x, int y);
+    bool allSunk(const Board& board) const;
+    bool fleetPlaced(const Board& board) const { return board.placedMask == (1u << config->fleet.size()) - 1; }
+    std::pair<int, int> computerMove();
+    void onComputerResult(int x, int y, Field::AttackResult result);
+
+public:
+    CompactGameSession(const BoardConfig& config, uint64_t seed);
+    
+    bool placeShip(int x, int y, int length, bool vertical) override;
+    bool placeAllShips() override;
+    bool start() override;
+    bool shoot(int x, int y, std::string& out) override;
+    Phase getPhase() const override { return phase; }
+    bool hasComputerFleet() const override { return fleetPlaced(boards[1]); }
+};
+
+#endif
@@ -1,11 +1,114 @@
 #include "Graphics.h"
 #include <iostream>
+#include <cmath>
+#include <chrono>
+#include <cstdio>
 
 // вспомогательная функция для исправления кодировки (UTF-8 -> SFML String)
 sf::String fromUtf8(const std::string& str) {
     return sf::String::fromUtf8(str.begin(), str.end());
 }
 
+// CachedText
+
+CachedText::CachedText() : built(false) {}
+
+CachedText::CachedText(const sf::Font& font, unsigned characterSize, sf::Color color) : built(false) {
+    text.setFont(font);
+    text.setCharacterSize(characterSize);
+    text.setFillColor(color);
+}
+
+bool CachedText::setString(const std::string& value) {
+    if (built && value == source) return false;
+    source = value;
+    text.setString(fromUtf8(value));
+    built = true;
+    return true;
+}
+
+void CachedText::draw(sf::RenderTarget& target, sf::RenderStates states) const {
+    target.draw(text, states);
+    PerformanceHud::countDrawCall();
+}
+
+// RollingStat
+
+RollingStat::RollingStat() : samples(), count(0), next(0) {
+    sorted.reserve(WINDOW);
+}
+
+void RollingStat::add(float value) {
+    samples[next] = value;
+    next = (next + 1) % WINDOW;
+    count = std::min(count + 1, WINDOW);
+}
+
+float RollingStat::percentile(float fraction) const {
+    if (count == 0) return 0.0f;
+    sorted.assign(samples, samples + count);
+    auto nth = sorted.begin() + std::min(count - 1, static_cast<int>(fraction * count));
+    std::nth_element(sorted.begin(), nth, sorted.end());
+    return *nth;
+}
+
+// PerformanceHud
+
+int PerformanceHud::drawCalls = 0;
+
+PerformanceHud::PerformanceHud() 
+    : frame(), visible(false), textStale(true), framesRendered(0), framesSkipped(0) {
+    background.setFillColor(sf::Color(0, 0, 0, 170));
+    background.setPosition(5, 5);
+}
+
+void PerformanceHud::setFont(const sf::Font& font) {
+    text = CachedText(font, 13, sf::Color::White);
+    text.setPosition(12, 10);
+}
+
+void PerformanceHud::beginFrame() {
+    drawCalls = 0;
+    std::fill(frame, frame + METRIC_COUNT, 0.0f);
+}
+
+void PerformanceHud::endFrame(float frameMilliseconds) {
+    stats[FrameTime].add(frameMilliseconds);
+    stats[DrawCalls].add(static_cast<float>(drawCalls));
+    stats[FieldDraw].add(frame[FieldDraw]);
+    stats[TextDraw].add(frame[TextDraw]);
+}
+
+void PerformanceHud::draw(sf::RenderTarget& target) {
+    static const char* const NAMES[METRIC_COUNT] = {
+        "кадр, мс", "вызовов draw", "поля, мс", "надписи, мс", "ход ИИ, мс"
+    };
+    
+    if (textStale || refreshClock.getElapsedTime().asMilliseconds() >= REFRESH_MS) {
+        textStale = false;
+        refreshClock.restart();
+        
+        // кириллица занимает по два байта, поэтому без выравнивания по столбцам
+        std::string lines = "p50 / p99 (F3 - скрыть)";
+        char line[96];
+        for (int i = 0; i < METRIC_COUNT; i++) {
+            std::snprintf(line, sizeof(line), "\n%s: %.2f / %.2f", NAMES[i],
+                          stats[i].percentile(0.5f), stats[i].percentile(0.99f));
+            lines += line;
+        }
+        std::snprintf(line, sizeof(line), "\nкадров: %lld, без перерисовки: %lld", framesRendered, framesSkipped);
+        lines += line;
+        // окно меняет размер, только когда пересобран текст
+        if (text.setString(lines)) {
+            sf::FloatRect bounds = text.getLocalBounds();
+            background.setSize(sf::Vector2f(bounds.width + 16, bounds.height + 16));
+        }
+    }
+    target.draw(background);
+    countDrawCall();
+    target.draw(text);
+}
+
 // button
 
 Button::Button() : isHovered(false), isClicked(false) {
@@ -55,13 +158,15 @@ void Button::setColors(sf::Color normal, sf::Color hover, sf::Color click) {
     clickColor = click;
 }
 
-void Button::update(const sf::Vector2i& mousePos) {
+bool Button::update(const sf::Vector2i& mousePos) {
+    sf::Color previous = shape.getFillColor();
     isHovered = contains(mousePos);
     if (isHovered) {
         shape.setFillColor(sf::Mouse::isButtonPressed(sf::Mouse::Left) ? clickColor : hoverColor);
     } else {
         shape.setFillColor(normalColor);
     }
+    return shape.getFillColor() != previous;
 }
 
 bool Button::isPressed(const sf::Event& event, const sf::Vector2i& mousePos) {
@@ -75,6 +180,7 @@ bool Button::isPressed(const sf::Event& event, const sf::Vector2i& mousePos) {
 void Button::draw(sf::RenderWindow& window) {
     window.draw(shape);
     window.draw(text);
+    PerformanceHud::countDrawCall(2);
 }
 
 bool Button::contains(const sf::Vector2i& point) const {
@@ -83,9 +189,14 @@ bool Button::contains(const sf::Vector2i& point) const {
 
 // FieldRenderer
 
-FieldRenderer::FieldRenderer(float x, float y, float size, const std::string& title, 
+FieldRenderer::FieldRenderer(float x, float y, float size, int fieldSize, const std::string& title, 
               sf::Font& font, bool hideShips)
-    : offsetX(x), offsetY(y), cellSize(size), hideShips(hideShips), title(title), font(font) {
+    : offsetX(x), offsetY(y), cellSize(size), fieldSize(fieldSize), hideShips(hideShips), 
+      title(title), font(font), 
+      cells(sf::Triangles, static_cast<size_t>(fieldSize) * fieldSize * VERTICES_PER_CELL),
+      drawnLooks(static_cast<size_t>(fieldSize) * fieldSize, CellLook::None), 
+      drawnHash(0), drawnHidden(hideShips), preview(sf::Triangles), 
+      labelsBuilt(false), labelsBaked(false) {
 }
 
 sf::Color FieldRenderer::getColorForState(CellState state, bool hide) const {
@@ -100,100 +211,208 @@ sf::Color FieldRenderer::getColorForState(CellState state, bool hide) const {
     }
 }
 
-void FieldRenderer::draw(sf::RenderWindow& window, const Field& field) {
-    drawLabels(window);
+FieldRenderer::CellLook FieldRenderer::lookFor(CellState state) const {
+    switch (state) {
+        case CellState::Ship:      return hideShips ? CellLook::Water : CellLook::Ship;
+        case CellState::Blocked:   return hideShips ? CellLook::Water : CellLook::Blocked;
+        case CellState::Miss:      return CellLook::Miss;
+        case CellState::Hit:       return CellLook::Hit;
+        case CellState::Destroyed: return CellLook::Destroyed;
+        default:                   return CellLook::Water;
+    }
+}
+
+void FieldRenderer::writeLine(sf::Vertex* vertices, sf::Vector2f from, sf::Vector2f to, 
+                              float width, sf::Color color) const {
+    sf::Vector2f direction = to - from;
+    float length = std::sqrt(direction.x * direction.x + direction.y * direction.y);
+    sf::Vector2f normal(-direction.y / length * width / 2, direction.x / length * width / 2);
     
-    for (int y = 0; y < GameConfig::FIELD_SIZE; y++) {
-        for (int x = 0; x < GameConfig::FIELD_SIZE; x++) {
-            const Cell& cell = field.getCell(x, y);
-            
-            sf::RectangleShape rect(sf::Vector2f(cellSize - 1, cellSize - 1));
-            rect.setPosition(offsetX + x * cellSize, offsetY + y * cellSize);
-            rect.setFillColor(getColorForState(cell.getState(), hideShips));
-            
-            if (!hideShips && cell.getState() == CellState::Blocked) {
-                sf::CircleShape dot(2);
-                dot.setFillColor(sf::Color(150, 150, 200));
-                dot.setPosition(
-                    rect.getPosition().x + cellSize/2 - 2,
-                    rect.getPosition().y + cellSize/2 - 2
-                );
-                window.draw(rect);
-                window.draw(dot);
-                continue;
+    const sf::Vector2f corners[6] = {from + normal, to + normal, to - normal, 
+                                     from + normal, to - normal, from - normal};
+    for (int i = 0; i < 6; i++) {
+        vertices[i] = sf::Vertex(corners[i], color);
+    }
+}
+
+void FieldRenderer::writeDot(sf::Vertex* vertices, sf::Vector2f center, float radius, sf::Color color) const {
+    // шестиугольник веером из 4 треугольников - на таких радиусах не отличить от круга
+    sf::Vector2f points[6];
+    for (int i = 0; i < 6; i++) {
+        float angle = static_cast<float>(i) * 3.14159265f / 3;
+        points[i] = center + sf::Vector2f(std::cos(angle) * radius, std::sin(angle) * radius);
+    }
+    for (int i = 0; i < 4; i++) {
+        vertices[3 * i] = sf::Vertex(points[0], color);
+        vertices[3 * i + 1] = sf::Vertex(points[i + 1], color);
+        vertices[3 * i + 2] = sf::Vertex(points[i + 2], color);
+    }
+}
+
+void FieldRenderer::writeCell(int x, int y, CellState state, CellLook look) {
+    sf::Vertex* vertices = &cells[(static_cast<size_t>(y) * fieldSize + x) * VERTICES_PER_CELL];
+    
+    // фон клетки
+    float left = offsetX + x * cellSize;
+    float top = offsetY + y * cellSize;
+    float right = left + cellSize - 1;
+    float bottom = top + cellSize - 1;
+    sf::Color color = getColorForState(state, hideShips);
+    vertices[0] = sf::Vertex(sf::Vector2f(left, top), color);
+    vertices[1] = sf::Vertex(sf::Vector2f(right, top), color);
+    vertices[2] = sf::Vertex(sf::Vector2f(right, bottom), color);
+    vertices[3] = sf::Vertex(sf::Vector2f(left, top), color);
+    vertices[4] = sf::Vertex(sf::Vector2f(right, bottom), color);
+    vertices[5] = sf::Vertex(sf::Vector2f(left, bottom), color);
+    
+    // отметка; в пустой клетке её вершины стягиваются в точку и ничего не рисуют
+    sf::Vertex* mark = vertices + 6;
+    sf::Vector2f center(left + cellSize / 2, top + cellSize / 2);
+    float inset = cellSize / 7;
+    switch (look) {
+        case CellLook::Hit:
+        case CellLook::Destroyed: {
+            float width = std::max(1.0f, cellSize / 20);
+            writeLine(mark, sf::Vector2f(left + inset, top + inset), 
+                      sf::Vector2f(left + cellSize - inset, top + cellSize - inset), width, sf::Color::Red);
+            writeLine(mark + 6, sf::Vector2f(left + cellSize - inset, top + inset), 
+                      sf::Vector2f(left + inset, top + cellSize - inset), width, sf::Color::Red);
+            break;
+        }
+        case CellLook::Miss:
+            writeDot(mark, center, std::min(4.0f, cellSize / 8), sf::Color::Black);
+            break;
+        case CellLook::Blocked:
+            writeDot(mark, center, std::min(2.0f, cellSize / 8), sf::Color(150, 150, 200));
+            break;
+        default:
+            for (int i = 0; i < MARK_VERTICES; i++) {
+                mark[i] = sf::Vertex(center, sf::Color::Transparent);
             }
+            break;
+    }
+}
 
-            window.draw(rect);
-            
-            if (cell.getState() == CellState::Hit || cell.getState() == CellState::Destroyed) {
-                sf::Vertex line1[] = {
-                    sf::Vertex(sf::Vector2f(rect.getPosition().x + 5, rect.getPosition().y + 5), sf::Color::Red),
-                    sf::Vertex(sf::Vector2f(rect.getPosition().x + cellSize - 5, rect.getPosition().y + cellSize - 5), sf::Color::Red)
-                };
-                sf::Vertex line2[] = {
-                    sf::Vertex(sf::Vector2f(rect.getPosition().x + cellSize - 5, rect.getPosition().y + 5), sf::Color::Red),
-                    sf::Vertex(sf::Vector2f(rect.getPosition().x + 5, rect.getPosition().y + cellSize - 5), sf::Color::Red)
-                };
-                window.draw(line1, 2, sf::Lines);
-                window.draw(line2, 2, sf::Lines);
-            } else if (cell.getState() == CellState::Miss) {
-                sf::CircleShape dot(4);
-                dot.setFillColor(sf::Color::Black);
-                dot.setOrigin(4, 4);
-                dot.setPosition(
-                    rect.getPosition().x + cellSize/2,
-                    rect.getPosition().y + cellSize/2
-                );
-                window.draw(dot);
+void FieldRenderer::update(const Field& field) {
+    // хеш Зобриста меняется с каждым выстрелом и кораблём: тот же хеш - поле не менялось
+    // (у настоящего поля хеш не бывает нулевым, поэтому первый вызов всегда рисует)
+    if (field.getHash() == drawnHash && hideShips == drawnHidden) return;
+    
+    for (int y = 0; y < fieldSize; y++) {
+        for (int x = 0; x < fieldSize; x++) {
+            CellState state = field.getCellState(x, y);
+            CellLook look = lookFor(state);
+            CellLook& drawn = drawnLooks[static_cast<size_t>(y) * fieldSize + x];
+            if (drawn != look) {
+                writeCell(x, y, state, look);
+                drawn = look;
             }
         }
     }
+    drawnHash = field.getHash();
+    drawnHidden = hideShips;
 }
 
-void FieldRenderer::drawGrid(sf::RenderWindow& window) {}
-
-void FieldRenderer::drawLabels(sf::RenderWindow& window) {
-    sf::Text titleText(fromUtf8(title), font, 22);
-    titleText.setFillColor(sf::Color::Black);
-    sf::FloatRect bounds = titleText.getLocalBounds();
-    titleText.setPosition(
-        offsetX + (GameConfig::FIELD_SIZE * cellSize - bounds.width) / 2,
-        offsetY - 55
-    );
-    window.draw(titleText);
+void FieldRenderer::draw(sf::RenderWindow& window, const Field& field) {
+    drawLabels(window);
+    update(field);
+    window.draw(cells);
+    PerformanceHud::countDrawCall();
+}
+
+void FieldRenderer::buildLabels() {
+    labels.clear();
+    
+    if (!title.empty()) {
+        sf::Text titleText(fromUtf8(title), font, 22);
+        titleText.setFillColor(sf::Color::Black);
+        sf::FloatRect bounds = titleText.getLocalBounds();
+        titleText.setPosition(
+            offsetX + (fieldSize * cellSize - bounds.width) / 2,
+            offsetY - 55
+        );
+        labels.push_back(titleText);
+    }
+    
+    // на мелких клетках подписываем не каждый столбец и строку
+    int step = std::max(1, static_cast<int>(std::ceil(24.0f / cellSize)));
+    float labelOffset = std::max(0.0f, (cellSize - 11) / 2);
     
-    for (int i = 0; i < GameConfig::FIELD_SIZE; i++) {
-        std::string letter;
-        letter += static_cast<char>('A' + i);
-        sf::Text text(letter, font, 14);
+    for (int i = 0; i < fieldSize; i += step) {
+        sf::Text text(Field::columnLabel(i), font, 14);
         text.setFillColor(sf::Color::Black);
-        text.setPosition(offsetX + i * cellSize + 12, offsetY - 20);
-        window.draw(text);
+        text.setPosition(offsetX + i * cellSize + labelOffset, offsetY - 20);
+        labels.push_back(text);
     }
-
-    for (int i = 0; i < GameConfig::FIELD_SIZE; i++) {
+    
+    for (int i = 0; i < fieldSize; i += step) {
         sf::Text text(std::to_string(i + 1), font, 14);
-        text. setFillColor(sf::Color::Black);
-        text.setPosition(offsetX - 20, offsetY + i * cellSize + 8);
+        text.setFillColor(sf::Color::Black);
+        text.setPosition(offsetX - 24, offsetY + i * cellSize + labelOffset - 4);
+        labels.push_back(text);
+    }
+    labelsBuilt = true;
+    
+    // область подписей: от заголовка над полем до подписей строк слева
+    const float margin = 40;
+    float left = offsetX - margin;
+    float top = offsetY - 60;
+    float fieldPixels = fieldSize * cellSize;
+    unsigned width = static_cast<unsigned>(std::ceil(fieldPixels + 2 * margin));
+    unsigned height = static_cast<unsigned>(std::ceil(fieldPixels + 60));
+    
+    labelsBaked = labelTexture.create(width, height);
+    if (!labelsBaked) return;
+    
+    labelTexture.clear(sf::Color::Transparent);
+    sf::Transform shift;
+    shift.translate(-left, -top);
+    for (const sf::Text& text : labels) {
+        labelTexture.draw(text, sf::RenderStates(shift));
+    }
+    labelTexture.display();
+    labelSprite.setTexture(labelTexture.getTexture(), true);
+    labelSprite.setPosition(left, top);
+}
+
+void FieldRenderer::drawLabels(sf::RenderWindow& window) {
+    if (!labelsBuilt) buildLabels();
+    
+    if (labelsBaked) {
+        window.draw(labelSprite);
+        PerformanceHud::countDrawCall();
+        return;
+    }
+    for (const sf::Text& text : labels) {
         window.draw(text);
     }
+    PerformanceHud::countDrawCall(static_cast<int>(labels.size()));
 }
 
 void FieldRenderer::drawShipPreview(sf::RenderWindow& window, int x, int y, 
                      int size, bool vertical, bool canPlace) {
     sf::Color color = canPlace ? sf::Color(100, 255, 100, 150) : sf::Color(255, 100, 100, 150);
     
+    preview.clear();
     for (int i = 0; i < size; i++) {
         int cx = vertical ? x : x + i;
         int cy = vertical ? y + i : y;
         
-        if (cx >= 0 && cx < 10 && cy >= 0 && cy < 10) {
-            sf::RectangleShape rect(sf::Vector2f(cellSize - 1, cellSize - 1));
-            rect.setPosition(offsetX + cx * cellSize, offsetY + cy * cellSize);
-            rect.setFillColor(color);
-            window.draw(rect);
+        if (cx >= 0 && cx < fieldSize && cy >= 0 && cy < fieldSize) {
+            float left = offsetX + cx * cellSize;
+            float top = offsetY + cy * cellSize;
+            float right = left + cellSize - 1;
+            float bottom = top + cellSize - 1;
+            preview.append(sf::Vertex(sf::Vector2f(left, top), color));
+            preview.append(sf::Vertex(sf::Vector2f(right, top), color));
+            preview.append(sf::Vertex(sf::Vector2f(right, bottom), color));
+            preview.append(sf::Vertex(sf::Vector2f(left, top), color));
+            preview.append(sf::Vertex(sf::Vector2f(right, bottom), color));
+            preview.append(sf::Vertex(sf::Vector2f(left, bottom), color));
         }
     }
+    window.draw(preview);
+    PerformanceHud::countDrawCall();
 }
 
 std::pair<int, int> FieldRenderer::getFieldCoords(const sf::Vector2i& mousePos) const {
@@ -206,8 +425,8 @@ std::pair<int, int> FieldRenderer::getFieldCoords(const sf::Vector2i& mousePos)
 }
 
 bool FieldRenderer::containsPoint(const sf::Vector2i& point) const {
-    float width = GameConfig::FIELD_SIZE * cellSize;
-    float height = GameConfig::FIELD_SIZE * cellSize;
+    float width = fieldSize * cellSize;
+    float height = fieldSize * cellSize;
     
     return point.x >= offsetX && point.x < offsetX + width &&
            point.y >= offsetY && point.y < offsetY + height;
@@ -215,15 +434,18 @@ bool FieldRenderer::containsPoint(const sf::Vector2i& point) const {
 
 // GameGUI 
 
-GameGUI::GameGUI() : state(GUIState::MainMenu), isPlayerTurn(true), gameOver(false), 
-                     computerThinking(false), playerShots(0), playerHits(0), 
-                     computerShots(0), computerHits(0) {
+GameGUI::GameGUI(const BoardConfig& config) 
+    : config(config), state(GUIState::MainMenu), isPlayerTurn(true), gameOver(false), 
+                     computerThinking(false), computerMoveMilliseconds(0.0f), playerShots(0), playerHits(0), 
+                     computerShots(0), computerHits(0), shownStats{-1, -1, -1, -1}, 
+                     needsRedraw(true), previewCell(-1, -1), framesRendered(0), framesSkipped(0) {
     
     sf::ContextSettings settings;
     settings.antialiasingLevel = 4;
     
     window.create(sf::VideoMode(GameConfig::WINDOW_WIDTH, GameConfig::WINDOW_HEIGHT), 
                  fromUtf8("Морской Бой (SFML)"), sf::Style::Titlebar | sf::Style::Close, settings);
+    // кадры строятся только по необходимости; лимит лишь сглаживает поток движений мыши
     window.setFramerateLimit(60);
 }
 
@@ -236,19 +458,23 @@ bool GameGUI::initialize() {
         }
     }
     
+    float cellSize = GameConfig::cellSizeFor(config.size);
+    
     playerFieldRenderer = std::make_unique<FieldRenderer>(
         GameConfig::MARGIN, 
         40, 
-        GameConfig::CELL_SIZE, 
+        cellSize, 
+        config.size,
         "",
         font, 
         false 
     );
     
     computerFieldRenderer = std::make_unique<FieldRenderer>(
-        GameConfig::MARGIN * 2 + GameConfig::FIELD_SIZE * GameConfig::CELL_SIZE, 
+        GameConfig::MARGIN * 2 + GameConfig::FIELD_PIXELS, 
         40, 
-        GameConfig::CELL_SIZE, 
+        cellSize, 
+        config.size,
         "",
         font, 
         true 
@@ -256,6 +482,8 @@ bool GameGUI::initialize() {
     
     initializeMenuButtons();
     initializeGameButtons();
+    initializeTexts();
+    hud.setFont(font);
     
     return true;
 }
@@ -286,82 +514,153 @@ void GameGUI::initializeGameButtons() {
 }
 
 void GameGUI::startNewGame() {
-    player = std::make_unique<HumanPlayer>("Игрок");
-    computer = std::make_unique<ComputerPlayer>("Компьютер");
+    // недосчитанный ход прежней партии дожидаемся, прежде чем удалить его игрока
+    if (pendingMove.valid()) pendingMove.wait();
+    pendingMove = std::future<std::pair<int, int>>();
+    computerThinking = false;
+    
+    player = std::make_unique<HumanPlayer>("Игрок", config);
+    computer = std::make_unique<ComputerPlayer>("Компьютер", TargetingStrategy::HuntTarget, config);
+    computerRng.seed(threadRng()());
+    computer->setRng(&computerRng);
     
     player->getField().reset();
     computer->getField().reset();
-    computer->placeShips(); 
+    // флот компьютера тот же, что у игрока: не встал он - не встанет и у игрока
+    bool fleetFits = computer->placeShips();
     
-    shipPlacement.reset();
+    shipPlacement.reset(config);
     
     state = GUIState::PlacingShips;
     gameOver = false;
     isPlayerTurn = true;
-    statusMessage = "Расставьте корабли!";
+    statusMessage = fleetFits ? "Расставьте корабли!" : "Флот не помещается на поле!";
     
     playerShots = 0; playerHits = 0;
     computerShots = 0; computerHits = 0;
 }
 
 void GameGUI::run() {
+    needsRedraw = true;
+    
     while (window.isOpen()) {
         sf::Event event;
-        sf::Vector2i mousePos = sf::Mouse::getPosition(window);
         
+        // нечего рисовать и некого ждать - спим до следующего события окна
+        if (!needsRedraw && !hasPendingWork() && window.waitEvent(event)) {
+            processEvent(event);
+        }
         while (window.pollEvent(event)) {
-            if (event.type == sf::Event::Closed)
-                window.close();
-                
-            switch (state) {
-                case GUIState::MainMenu:
-                    handleMenuEvents(event);
-                    break;
-                case GUIState::PlacingShips:
-                    handlePlacingEvents(event);
-                    break;
-                case GUIState::Playing:
-                    handlePlayingEvents(event);
-                    break;
-                case GUIState::GameOver:
-                    handleGameOverEvents(event);
-                    break;
-            }
+            processEvent(event);
         }
+        if (!window.isOpen()) break;
         
         if (state == GUIState::Playing && !gameOver) {
             updatePlaying();
         }
         
-        if (state == GUIState::MainMenu) {
-            for (auto& btn : menuButtons) btn.update(mousePos);
-        } else if (state == GUIState::PlacingShips) {
-            rotateButton.update(mousePos);
-            autoPlaceButton.update(mousePos);
-            if (shipPlacement.allPlaced()) startGameButton.update(mousePos);
-        } else {
-            restartButton.update(mousePos);
+        if (!needsRedraw) {
+            framesSkipped++;
+            // компьютер «думает»: короткий сон вместо кадра
+            if (hasPendingWork()) sf::sleep(sf::milliseconds(PENDING_TICK_MS));
+            continue;
         }
         
-        window.clear(sf::Color::White);
+        render();
+    }
+}
+
+void GameGUI::processEvent(const sf::Event& event) {
+    if (event.type == sf::Event::Closed) {
+        window.close();
+        return;
+    }
+    if (event.type == sf::Event::KeyReleased && event.key.code == sf::Keyboard::F3) {
+        hud.toggle();
+        needsRedraw = true;
+        return;
+    }
+    
+    // движение мыши меняет кадр, только если сменилась подсветка кнопки или клетка призрака;
+    // остальные события (щелчки, клавиши, фокус, размер) перерисовывают всегда
+    if (event.type == sf::Event::MouseMoved) {
+        if (updateHover()) needsRedraw = true;
+    } else {
+        needsRedraw = true;
+    }
+    
+    switch (state) {
+        case GUIState::MainMenu:
+            handleMenuEvents(event);
+            break;
+        case GUIState::PlacingShips:
+            handlePlacingEvents(event);
+            break;
+        case GUIState::Playing:
+            handlePlayingEvents(event);
+            break;
+        case GUIState::GameOver:
+            handleGameOverEvents(event);
+            break;
+    }
+}
+
+bool GameGUI::updateHover() {
+    sf::Vector2i mousePos = sf::Mouse::getPosition(window);
+    bool changed = false;
+    
+    if (state == GUIState::MainMenu) {
+        for (auto& btn : menuButtons) changed |= btn.update(mousePos);
+    } else if (state == GUIState::PlacingShips) {
+        changed |= rotateButton.update(mousePos);
+        changed |= autoPlaceButton.update(mousePos);
+        if (shipPlacement.allPlaced()) changed |= startGameButton.update(mousePos);
         
-        switch (state) {
-            case GUIState::MainMenu:
-                drawMenu();
-                break;
-            case GUIState::PlacingShips:
-                drawPlacing();
-                break;
-            case GUIState::Playing:
-                drawPlaying();
-                break;
-            case GUIState::GameOver:
-                drawGameOver();
-                break;
+        std::pair<int, int> cell = playerFieldRenderer->getFieldCoords(mousePos);
+        if (cell != previewCell) {
+            previewCell = cell;
+            changed = true;
         }
-        
-        window.display();
+    } else {
+        changed |= restartButton.update(mousePos);
     }
+    return changed;
+}
+
+bool GameGUI::hasPendingWork() const {
+    return state == GUIState::Playing && !gameOver && !isPlayerTurn;
+}
+
+void GameGUI::render() {
+    sf::Clock frameClock;
+    hud.beginFrame();
+    updateHover();
+    window.clear(sf::Color::White);
+    
+    switch (state) {
+        case GUIState::MainMenu:
+            drawMenu();
+            break;
+        case GUIState::PlacingShips:
+            drawPlacing();
+            break;
+        case GUIState::Playing:
+            drawPlaying();
+            break;
+        case GUIState::GameOver:
+            drawGameOver();
+            break;
+    }
+    if (hud.isVisible()) {
+        hud.setFrameCounts(framesRendered, framesSkipped);
+        hud.draw(window);
+    }
+    
+    // время кадра - до display: в display ждёт лимит кадров, и кадр выглядел бы не короче 1/60 с
+    hud.endFrame(frameClock.getElapsedTime().asMicroseconds() / 1000.0f);
+    window.display();
+    needsRedraw = false;
+    framesRendered++;
 }
 
 void GameGUI::handleMenuEvents(const sf::Event& event) {
@@ -390,16 +689,18 @@ void GameGUI::handlePlacingEvents(const sf::Event& event) {
     }
     
     if (autoPlaceButton.isPressed(event, mousePos)) {
-        player->getField().placeAllShipsAuto();
-        shipPlacement.shipsToPlace[0] = 0;
-        shipPlacement.shipsToPlace[1] = 0;
-        shipPlacement.shipsToPlace[2] = 0;
-        shipPlacement.shipsToPlace[3] = 0;
-        statusMessage = "Корабли расставлены. Нажмите кнопку для старта.";
-        
-        startGameButton.setPosition(GameConfig::WINDOW_WIDTH - 250, GameConfig::WINDOW_HEIGHT - 80);
-        startGameButton.setSize(200, 40);
-        startGameButton.setText("В БОЙ!", font);
+        if (player->getField().placeAllShipsAuto()) {
+            shipPlacement.placeAll();
+            statusMessage = "Корабли расставлены. Нажмите кнопку для старта.";
+            
+            startGameButton.setPosition(GameConfig::WINDOW_WIDTH - 250, GameConfig::WINDOW_HEIGHT - 80);
+            startGameButton.setSize(200, 40);
+            startGameButton.setText("В БОЙ!", font);
+        } else {
+            player->getField().reset();
+            shipPlacement.reset(config);
+            statusMessage = "Флот не помещается на поле!";
+        }
     }
     
     if (shipPlacement.allPlaced()) {
@@ -423,7 +724,7 @@ void GameGUI::handlePlacingEvents(const sf::Event& event) {
                 int size = shipPlacement.getNextShipSize();
                 if (size > 0) {
                     if (player->getField().placeShip(coords.first, coords.second, size, shipPlacement.isVertical)) {
-                        shipPlacement.shipsToPlace[4 - size]--;
+                        shipPlacement.shipsToPlace[size]--;
                         
                         if (shipPlacement.allPlaced()) {
                             startGameButton.setPosition(GameConfig::WINDOW_WIDTH - 250, GameConfig::WINDOW_HEIGHT - 80);
@@ -479,29 +780,39 @@ void GameGUI::updatePlaying() {
         if (!computerThinking) {
             computerThinking = true;
             computerThinkClock.restart();
+            pendingMove = std::async(std::launch::async, [this] {
+                sf::Clock moveClock;
+                std::pair<int, int> move = computer->makeMove();
+                computerMoveMilliseconds = moveClock.getElapsedTime().asMicroseconds() / 1000.0f;
+                return move;
+            });
         } else {
-            if (computerThinkClock.getElapsedTime().asSeconds() > 0.5f) {
-                auto coords = computer->makeMove();
-                Field::AttackResult result = player->getField().attack(coords.first, coords.second);
-                
-                computerShots++;
-                
-                if (result == Field::AttackResult::Hit || result == Field::AttackResult::Destroyed) {
-                    computerHits++;
-                    computer->onHit(coords.first, coords.second);
-                    statusMessage = "Компьютер попал! Его ход.";
-                    if (result == Field::AttackResult::Destroyed) {
-                        computer->onDestroyed();
-                        statusMessage = "Компьютер уничтожил ваш корабль!";
-                    }
-                    checkGameOver();
-                    computerThinking = false; 
-                    computerThinkClock.restart();
-                } else {
-                    statusMessage = "Компьютер промахнулся. Ваш ход!";
-                    isPlayerTurn = true;
-                    computerThinking = false;
+            // ход показывается, когда он готов и прошла пауза
+            if (computerThinkClock.getElapsedTime().asSeconds() < COMPUTER_THINK_SECONDS ||
+                pendingMove.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+                return;
+            }
+            
+            auto coords = pendingMove.get();
+            hud.record(PerformanceHud::ComputerMove, computerMoveMilliseconds);
+            Field::AttackResult result = player->getField().attack(coords.first, coords.second);
+            
+            computerShots++;
+            computer->onAttackResult(coords.first, coords.second, result);
+            needsRedraw = true;
+            
+            if (result == Field::AttackResult::Hit || result == Field::AttackResult::Destroyed) {
+                computerHits++;
+                statusMessage = "Компьютер попал! Его ход.";
+                if (result == Field::AttackResult::Destroyed) {
+                    statusMessage = "Компьютер уничтожил ваш корабль!";
                 }
+                checkGameOver();
+                computerThinking = false; 
+            } else {
+                statusMessage = "Компьютер промахнулся. Ваш ход!";
+                isPlayerTurn = true;
+                computerThinking = false;
             }
         }
     }
@@ -517,15 +828,54 @@ void GameGUI::checkGameOver() {
         winnerName = "Компьютер";
         state = GUIState::GameOver;
     }
+    
+    if (gameOver && winText.setString(winnerName + " ПОБЕДИЛ!")) {
+        sf::FloatRect bounds = winText.getLocalBounds();
+        winText.setPosition((GameConfig::WINDOW_WIDTH - bounds.width) / 2, GameConfig::WINDOW_HEIGHT / 2 - 50);
+    }
+}
+
+void GameGUI::initializeTexts() {
+    menuTitleText = CachedText(font, 50, sf::Color(0, 50, 100));
+    menuTitleText.getText().setStyle(sf::Text::Bold);
+    menuTitleText.setString("МОРСКОЙ БОЙ");
+    sf::FloatRect bounds = menuTitleText.getLocalBounds();
+    menuTitleText.setPosition((GameConfig::WINDOW_WIDTH - bounds.width) / 2, 50);
+    
+    statusText = CachedText(font, 24, sf::Color::Black);
+    
+    winText = CachedText(font, 60, sf::Color::Green);
+    winText.getText().setOutlineColor(sf::Color::White);
+    winText.getText().setOutlineThickness(2);
+    
+    int startX = GameConfig::MARGIN * 2 + GameConfig::FIELD_PIXELS + 50;
+    int startY = 100;
+    shipsHeaderText = CachedText(font, 20, sf::Color::Black);
+    shipsHeaderText.setString("Осталось расставить:");
+    shipsHeaderText.setPosition(startX, startY);
+    
+    // строки идут в порядке длин флота от большей к меньшей, их места постоянны
+    int maxLength = config.maxShipLength();
+    shipLineTexts.assign(maxLength + 1, CachedText(font, 18, sf::Color(50, 50, 50)));
+    shownShipsToPlace.assign(maxLength + 1, -1);
+    int row = 0;
+    for (int length = maxLength; length > 0; length--) {
+        if (config.shipCount(length) == 0) continue;
+        shipLineTexts[length].setPosition(startX, startY + 40 + row * 30);
+        row++;
+    }
+    
+    playerStatsText = CachedText(font, 16, sf::Color::Black);
+    playerStatsText.setPosition(GameConfig::MARGIN, GameConfig::WINDOW_HEIGHT - 60);
+    computerStatsText = CachedText(font, 16, sf::Color::Black);
+    computerStatsText.setPosition(GameConfig::WINDOW_WIDTH - 200, GameConfig::WINDOW_HEIGHT - 60);
 }
 
 void GameGUI::drawMenu() {
-    sf::Text title(fromUtf8("МОРСКОЙ БОЙ"), font, 50);
-    title.setFillColor(sf::Color(0, 50, 100));
-    title.setStyle(sf::Text::Bold);
-    sf::FloatRect bounds = title.getLocalBounds();
-    title.setPosition((GameConfig::WINDOW_WIDTH - bounds.width) / 2, 50);
-    window.draw(title);
+    {
+        PerformanceHud::Section section(hud, PerformanceHud::TextDraw);
+        window.draw(menuTitleText);
+    }
     
     for (auto& btn : menuButtons) {
         btn.draw(window);
@@ -533,7 +883,10 @@ void GameGUI::drawMenu() {
 }
 
 void GameGUI::drawPlacing() {
-    playerFieldRenderer->draw(window, player->getField());
+    {
+        PerformanceHud::Section section(hud, PerformanceHud::FieldDraw);
+        playerFieldRenderer->draw(window, player->getField());
+    }
     drawShipsToPlace();
     
     rotateButton.draw(window);
@@ -546,6 +899,7 @@ void GameGUI::drawPlacing() {
         if (coords.first != -1) {
             int size = shipPlacement.getNextShipSize();
             bool canPlace = player->getField().canPlaceShip(coords.first, coords.second, size, shipPlacement.isVertical);
+            PerformanceHud::Section section(hud, PerformanceHud::FieldDraw);
             playerFieldRenderer->drawShipPreview(window, coords.first, coords.second, size, shipPlacement.isVertical, canPlace);
         }
     }
@@ -554,8 +908,11 @@ void GameGUI::drawPlacing() {
 }
 
 void GameGUI::drawPlaying() {
-    playerFieldRenderer->draw(window, player->getField());
-    computerFieldRenderer->draw(window, computer->getField());
+    {
+        PerformanceHud::Section section(hud, PerformanceHud::FieldDraw);
+        playerFieldRenderer->draw(window, player->getField());
+        computerFieldRenderer->draw(window, computer->getField());
+    }
     
     drawStatus();
     drawStatistics();
@@ -567,60 +924,55 @@ void GameGUI::drawGameOver() {
     sf::RectangleShape overlay(sf::Vector2f(GameConfig::WINDOW_WIDTH, GameConfig::WINDOW_HEIGHT));
     overlay.setFillColor(sf::Color(0, 0, 0, 150));
     window.draw(overlay);
+    PerformanceHud::countDrawCall();
     
-    sf::Text winText(fromUtf8(winnerName + " ПОБЕДИЛ!"), font, 60);
-    winText.setFillColor(sf::Color::Green);
-    winText.setOutlineColor(sf::Color::White);
-    winText.setOutlineThickness(2);
-    sf::FloatRect bounds = winText.getLocalBounds();
-    winText.setPosition((GameConfig::WINDOW_WIDTH - bounds.width) / 2, GameConfig::WINDOW_HEIGHT / 2 - 50);
-    window.draw(winText);
+    {
+        PerformanceHud::Section section(hud, PerformanceHud::TextDraw);
+        window.draw(winText);
+    }
     
     restartButton.setPosition((GameConfig::WINDOW_WIDTH - 200) / 2, GameConfig::WINDOW_HEIGHT / 2 + 50);
     restartButton.draw(window);
 }
 
 void GameGUI::drawStatus() {
-    sf::Text status(fromUtf8(statusMessage), font, 24);
-    status.setFillColor(sf::Color::Black);
-    sf::FloatRect bounds = status.getLocalBounds();
-    status.setPosition((GameConfig::WINDOW_WIDTH - bounds.width) / 2, GameConfig::WINDOW_HEIGHT - 130);
-    window.draw(status);
+    PerformanceHud::Section section(hud, PerformanceHud::TextDraw);
+    // сравнение со строкой в кэше не выделяет память; пересборка - только при новом сообщении
+    if (statusText.setString(statusMessage)) {
+        sf::FloatRect bounds = statusText.getLocalBounds();
+        statusText.setPosition((GameConfig::WINDOW_WIDTH - bounds.width) / 2, GameConfig::WINDOW_HEIGHT - 130);
+    }
+    window.draw(statusText);
 }
 
 void GameGUI::drawShipsToPlace() {
-    int startX = GameConfig::MARGIN * 2 + GameConfig::FIELD_SIZE * GameConfig::CELL_SIZE + 50;
-    int startY = 100;
-    
-    sf::Text header(fromUtf8("Осталось расставить:"), font, 20);
-    header.setFillColor(sf::Color::Black);
-    header.setPosition(startX, startY);
-    window.draw(header);
+    PerformanceHud::Section section(hud, PerformanceHud::TextDraw);
+    window.draw(shipsHeaderText);
     
-    std::string names[] = {"Линкор (4): ", "Крейсер (3): ", "Эсминец (2): ", "Катер (1): "};
-    for (int i = 0; i < 4; i++) {
-        sf::Text txt(fromUtf8(names[i] + std::to_string(shipPlacement.shipsToPlace[i])), font, 18);
-        txt.setFillColor(sf::Color(50, 50, 50));
-        txt.setPosition(startX, startY + 40 + i * 30);
-        window.draw(txt);
+    for (int length = static_cast<int>(shipPlacement.fleetCounts.size()) - 1; length > 0; length--) {
+        if (shipPlacement.fleetCounts[length] == 0) continue;
+        
+        int left = shipPlacement.shipsToPlace[length];
+        if (shownShipsToPlace[length] != left) {
+            shipLineTexts[length].setString(BoardConfig::shipName(length) + " (" + std::to_string(length) + "): " + 
+                                            std::to_string(left));
+            shownShipsToPlace[length] = left;
+        }
+        window.draw(shipLineTexts[length]);
     }
 }
 
 void GameGUI::drawStatistics() {
-    sf::Text statsText;
-    statsText.setFont(font);
-    statsText.setCharacterSize(16);
-    statsText.setFillColor(sf::Color::Black);
-    
-    std::string pStats = "Игрок:\nВыстрелов: " + std::to_string(playerShots) + 
-                         "\nПопаданий: " + std::to_string(playerHits);
-    statsText.setString(fromUtf8(pStats));
-    statsText.setPosition(GameConfig::MARGIN, GameConfig::WINDOW_HEIGHT - 60);
-    window.draw(statsText);
-    
-    std::string cStats = "Компьютер:\nВыстрелов: " + std::to_string(computerShots) + 
-                         "\nПопаданий: " + std::to_string(computerHits);
-    statsText.setString(fromUtf8(cStats));
-    statsText.setPosition(GameConfig::WINDOW_WIDTH - 200, GameConfig::WINDOW_HEIGHT - 60);
-    window.draw(statsText);
+    PerformanceHud::Section section(hud, PerformanceHud::TextDraw);
+    // строки собираются только когда меняются сами числа
+    const int stats[4] = {playerShots, playerHits, computerShots, computerHits};
+    if (!std::equal(stats, stats + 4, shownStats)) {
+        playerStatsText.setString("Игрок:\nВыстрелов: " + std::to_string(playerShots) + 
+                                  "\nПопаданий: " + std::to_string(playerHits));
+        computerStatsText.setString("Компьютер:\nВыстрелов: " + std::to_string(computerShots) + 
+                                    "\nПопаданий: " + std::to_string(computerHits));
+        std::copy(stats, stats + 4, shownStats);
+    }
+    window.draw(playerStatsText);
+    window.draw(computerStatsText);
 }
\ No newline at end of file
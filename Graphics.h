@@ -9,15 +9,25 @@
 #include "Game.h"
 #include <memory>
 #include <string>
+#include <vector>
+#include <algorithm>
+#include <future>
 
 // константы для отрисовки
+// поле любого размера занимает FIELD_PIXELS пикселей, клетка не крупнее CELL_SIZE
 namespace GameConfig {
     const int CELL_SIZE = 35;
-    const int FIELD_SIZE = 10;
+    const int FIELD_PIXELS = 350;
+    const int MAX_FIELD_SIZE = 70;  // больше - клетка мельче 5 пикселей
     const int MARGIN = 50;
     const int FIELD_GAP = 100;
-    const int WINDOW_WIDTH = MARGIN * 3 + FIELD_SIZE * CELL_SIZE * 2 + FIELD_GAP;
-    const int WINDOW_HEIGHT = MARGIN * 2 + FIELD_SIZE * CELL_SIZE + 150;
+    const int WINDOW_WIDTH = MARGIN * 3 + FIELD_PIXELS * 2 + FIELD_GAP;
+    const int WINDOW_HEIGHT = MARGIN * 2 + FIELD_PIXELS + 150;
+    
+    // размер клетки в пикселях для поля fieldSize x fieldSize
+    inline float cellSizeFor(int fieldSize) {
+        return std::min(static_cast<float>(CELL_SIZE), static_cast<float>(FIELD_PIXELS) / fieldSize);
+    }
 }
 
 enum class GUIState {
@@ -27,6 +37,29 @@ enum class GUIState {
     GameOver
 };
 
+// надпись, которая пересобирается только при смене строки:
+// sf::Text строит геометрию глифов заново на каждый setString, а кадров 60 в секунду
+class CachedText : public sf::Drawable {
+private:
+    sf::Text text;
+    std::string source;  // строка, из которой собран text
+    bool built;
+    
+protected:
+    void draw(sf::RenderTarget& target, sf::RenderStates states) const override;
+    
+public:
+    CachedText();
+    CachedText(const sf::Font& font, unsigned characterSize, sf::Color color);
+    
+    // true - строка изменилась и текст пересобран (пора пересчитать положение)
+    bool setString(const std::string& value);
+    
+    sf::Text& getText() { return text; }
+    sf::FloatRect getLocalBounds() const { return text.getLocalBounds(); }
+    void setPosition(float x, float y) { text.setPosition(x, y); }
+};
+
 class Button {
 private:
     sf::RectangleShape shape;
@@ -47,7 +80,8 @@ public:
     void setText(const std::string& buttonText, const sf::Font& font);
     void setColors(sf::Color normal, sf::Color hover, sf::Color click);
     
-    void update(const sf::Vector2i& mousePos);
+    // true - цвет кнопки поменялся и её нужно перерисовать
+    bool update(const sf::Vector2i& mousePos);
     bool isPressed(const sf::Event& event, const sf::Vector2i& mousePos);
     void draw(sf::RenderWindow& window);
     
@@ -55,22 +89,54 @@ public:
 };
 
 // класс для отображения игрового поля
+// клетки хранятся готовой геометрией (один массив вершин на поле, рисуется одним вызовом);
+// между кадрами переписываются только клетки, чей вид изменился
 class FieldRenderer {
 private:
+    // вершин на клетку: фон (2 треугольника) и отметка (до 4 треугольников)
+    static const int VERTICES_PER_CELL = 18;
+    static const int MARK_VERTICES = 12;
+    
+    // что нарисовано в клетке с учётом скрытия кораблей
+    enum class CellLook : uint8_t {
+        Water, Ship, Blocked, Miss, Hit, Destroyed, 
+        None  // клетка ещё не рисовалась
+    };
+    
     float offsetX, offsetY;
     float cellSize;
+    int fieldSize;
     bool hideShips;
     std::string title;
     sf::Font& font;
     
+    sf::VertexArray cells;            // VERTICES_PER_CELL вершин на клетку, по строкам
+    std::vector<CellLook> drawnLooks;
+    uint64_t drawnHash;               // хеш поля на момент последнего обновления
+    bool drawnHidden;
+    sf::VertexArray preview;          // призрак размещаемого корабля
+    
+    // заголовок и подписи строк и столбцов не меняются: собираются один раз
+    // и запекаются в текстуру, которая рисуется одним спрайтом
+    std::vector<sf::Text> labels;
+    sf::RenderTexture labelTexture;
+    sf::Sprite labelSprite;
+    bool labelsBuilt;
+    bool labelsBaked;  // текстура создана; иначе подписи рисуются готовыми sf::Text
+    
     sf::Color getColorForState(CellState state, bool hide) const;
+    CellLook lookFor(CellState state) const;
+    void update(const Field& field);
+    void writeCell(int x, int y, CellState state, CellLook look);
+    void writeLine(sf::Vertex* vertices, sf::Vector2f from, sf::Vector2f to, float width, sf::Color color) const;
+    void writeDot(sf::Vertex* vertices, sf::Vector2f center, float radius, sf::Color color) const;
+    void buildLabels();
     
 public:
-    FieldRenderer(float x, float y, float size, const std::string& title, 
+    FieldRenderer(float x, float y, float size, int fieldSize, const std::string& title, 
                   sf::Font& font, bool hideShips = false);
     
     void draw(sf::RenderWindow& window, const Field& field);
-    void drawGrid(sf::RenderWindow& window);
     void drawLabels(sf::RenderWindow& window);
     void drawShipPreview(sf::RenderWindow& window, int x, int y, 
                          int size, bool vertical, bool canPlace);
@@ -82,11 +148,86 @@ public:
     void setHideShips(bool hide) { hideShips = hide; }
 };
 
+// скользящее окно последних замеров: медиана и 99-й перцентиль без хранения всей истории
+class RollingStat {
+private:
+    static const int WINDOW = 240;  // около 4 секунд кадров при 60 в секунду
+    
+    float samples[WINDOW];
+    int count;
+    int next;
+    mutable std::vector<float> sorted;  // рабочая копия для nth_element
+    
+public:
+    RollingStat();
+    
+    void add(float value);
+    // fraction от 0 до 1; пустое окно - 0
+    float percentile(float fraction) const;
+    bool empty() const { return count == 0; }
+};
+
+// оверлей производительности (F3): время кадра, вызовы draw, время полей и надписей
+// в кадре и задержка хода компьютера, по каждой метрике p50/p99 за последние замеры
+class PerformanceHud {
+public:
+    enum Metric { FrameTime, DrawCalls, FieldDraw, TextDraw, ComputerMove, METRIC_COUNT };
+    
+    // замер участка кадра: время участка прибавляется к метрике текущего кадра
+    class Section {
+    private:
+        PerformanceHud& hud;
+        Metric metric;
+        sf::Clock clock;
+        
+    public:
+        Section(PerformanceHud& hud, Metric metric) : hud(hud), metric(metric) {}
+        ~Section() { hud.add(metric, clock.getElapsedTime().asMicroseconds() / 1000.0f); }
+    };
+    
+private:
+    RollingStat stats[METRIC_COUNT];
+    float frame[METRIC_COUNT];  // накопленное за текущий кадр
+    bool visible;
+    sf::RectangleShape background;
+    CachedText text;
+    
+    // текст пересобирается не чаще раза в REFRESH_MS: подсчёт процентилей и строки - не каждый кадр
+    static const int REFRESH_MS = 250;
+    sf::Clock refreshClock;
+    bool textStale;             // показать свежие значения в ближайшем кадре
+    long long framesRendered;   // счётчики цикла GUI на момент последнего кадра
+    long long framesSkipped;
+    
+    static int drawCalls;       // вызовов draw с начала кадра; рисует только поток GUI
+    
+public:
+    PerformanceHud();
+    
+    void setFont(const sf::Font& font);
+    void toggle() { visible = !visible; textStale = true; }
+    bool isVisible() const { return visible; }
+    
+    void beginFrame();
+    void add(Metric metric, float value) { frame[metric] += value; }
+    void endFrame(float frameMilliseconds);
+    // нарисованные кадры и пробуждения цикла без перерисовки с начала работы
+    void setFrameCounts(long long rendered, long long skipped) { framesRendered = rendered; framesSkipped = skipped; }
+    // замер вне кадра (ход компьютера считается в своём потоке)
+    void record(Metric metric, float value) { stats[metric].add(value); }
+    
+    // показывает значения по уже законченным кадрам, обновляя их раз в REFRESH_MS
+    void draw(sf::RenderTarget& target);
+    
+    static void countDrawCall(int calls = 1) { drawCalls += calls; }
+};
+
 // главный класс графического интерфейса
 class GameGUI {
 private:
     sf::RenderWindow window;
     sf::Font font;
+    BoardConfig config;
     
     // состояние игры
     GUIState state;
@@ -107,30 +248,33 @@ private:
     
     // состояние расстановки кораблей
     struct ShipPlacement {
-        int shipsToPlace[4] = {1, 2, 3, 4}; // 4-палубный, 3-палубные, 2-палубные, 1-палубные
-        int currentShipSize = 4;
+        std::vector<int> shipsToPlace;  // сколько осталось кораблей каждой длины
+        std::vector<int> fleetCounts;   // сколько их во флоте
         bool isVertical = true;
         
         int getNextShipSize() const {
-            for (int i = 0; i < 4; i++) {
-                if (shipsToPlace[i] > 0) {
-                    return 4 - i;
+            for (int length = static_cast<int>(shipsToPlace.size()) - 1; length > 0; length--) {
+                if (shipsToPlace[length] > 0) {
+                    return length;
                 }
             }
             return 0;
         }
         
         bool allPlaced() const {
-            return shipsToPlace[0] == 0 && shipsToPlace[1] == 0 && 
-                   shipsToPlace[2] == 0 && shipsToPlace[3] == 0;
+            return getNextShipSize() == 0;
+        }
+        
+        void placeAll() {
+            std::fill(shipsToPlace.begin(), shipsToPlace.end(), 0);
         }
         
-        void reset() {
-            shipsToPlace[0] = 1;
-            shipsToPlace[1] = 2;
-            shipsToPlace[2] = 3;
-            shipsToPlace[3] = 4;
-            currentShipSize = 4;
+        void reset(const BoardConfig& config) {
+            fleetCounts.assign(config.maxShipLength() + 1, 0);
+            for (int length : config.fleet) {
+                fleetCounts[length]++;
+            }
+            shipsToPlace = fleetCounts;
             isVertical = true;
         }
     } shipPlacement;
@@ -143,19 +287,51 @@ private:
     sf::Clock computerThinkClock;
     bool computerThinking;
     
+    // ход компьютера считается в отдельном потоке, окно тем временем рисуется и принимает ввод;
+    // пока ход не получен, поток GUI не трогает состояние наведения компьютера (только поля)
+    static constexpr float COMPUTER_THINK_SECONDS = 0.5f;  // минимальная пауза перед показом хода
+    Rng computerRng;                                      // свой генератор: ход не зависит от потока
+    std::future<std::pair<int, int>> pendingMove;
+    float computerMoveMilliseconds;  // пишет поток хода, читается после pendingMove.get()
+    
     // статистика
     int playerShots;
     int playerHits;
     int computerShots;
     int computerHits;
     
+    // надписи пересобираются только при смене показываемых значений
+    CachedText menuTitleText;
+    CachedText statusText;
+    CachedText winText;
+    CachedText shipsHeaderText;
+    std::vector<CachedText> shipLineTexts;  // по строке на каждую длину корабля во флоте
+    std::vector<int> shownShipsToPlace;     // значения, по которым собраны shipLineTexts
+    CachedText playerStatsText;
+    CachedText computerStatsText;
+    int shownStats[4];                      // выстрелы и попадания игрока и компьютера в надписях
+    
+    // перерисовка по необходимости: кадр строится после ввода, смены состояния
+    // или хода компьютера, а в простое цикл спит в waitEvent
+    static const int PENDING_TICK_MS = 15;  // шаг ожидания, пока компьютер «думает»
+    bool needsRedraw;
+    std::pair<int, int> previewCell;        // клетка под призраком корабля в последнем кадре
+    long long framesRendered;
+    long long framesSkipped;                // пробуждения цикла без перерисовки
+    PerformanceHud hud;
+    
     // приватные методы
     void initializeMenuButtons();
     void initializeGameButtons();
+    void initializeTexts();
     void handleMenuEvents(const sf::Event& event);
     void handlePlacingEvents(const sf::Event& event);
     void handlePlayingEvents(const sf::Event& event);
     void handleGameOverEvents(const sf::Event& event);
+    void processEvent(const sf::Event& event);
+    bool updateHover();
+    bool hasPendingWork() const;
+    void render();
     
     void updatePlacing();
     void updatePlaying();
@@ -173,7 +349,7 @@ private:
     void checkGameOver();
     
 public:
-    GameGUI();
+    explicit GameGUI(const BoardConfig& config = BoardConfig());
     ~GameGUI() = default;
     
     bool initialize();
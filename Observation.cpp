@@ -0,0 +1,88 @@
+#include "Observation.h"
+#include <algorithm>
+
+Observation::Observation(int size, const std::vector<int>& fleet) 
+    : size(size), misses(size * size), hits(size * size), sunk(size * size), 
+      remainingShips(fleet), hash(Zobrist::boardKey(size, fleet)) {}
+
+void Observation::reset(const std::vector<int>& fleet) {
+    misses.clear();
+    hits.clear();
+    sunk.clear();
+    remainingShips = fleet;
+    hash = Zobrist::boardKey(size, fleet);
+}
+
+void Observation::setMiss(int index) {
+    if (!misses.test(index)) {
+        misses.set(index);
+        hash ^= Zobrist::key(index, Zobrist::Miss);
+    }
+}
+
+void Observation::recordMiss(int x, int y) {
+    if (!isValidPosition(x, y)) return;
+    int index = cellIndex(x, y);
+    if (!hits.test(index) && !sunk.test(index)) {
+        setMiss(index);
+    }
+}
+
+void Observation::recordHit(int x, int y) {
+    if (!isValidPosition(x, y)) return;
+    int index = cellIndex(x, y);
+    if (!hits.test(index)) {
+        hits.set(index);
+        hash ^= Zobrist::key(index, Zobrist::Hit);
+    }
+}
+
+void Observation::recordDestroyed(int x, int y) {
+    if (!isValidPosition(x, y)) return;
+    recordHit(x, y);
+    
+    // корабли не касаются друг друга, поэтому подбитые клетки в одну линию 
+    // с последним выстрелом и есть потопленный корабль
+    int left = x, right = x, top = y, bottom = y;
+    while (left > 0 && hits.test(cellIndex(left - 1, y))) left--;
+    while (right < size - 1 && hits.test(cellIndex(right + 1, y))) right++;
+    while (top > 0 && hits.test(cellIndex(x, top - 1))) top--;
+    while (bottom < size - 1 && hits.test(cellIndex(x, bottom + 1))) bottom++;
+    
+    if (right - left >= bottom - top) {
+        top = bottom = y;
+    } else {
+        left = right = x;
+    }
+    
+    // длина потопленного корабля входит в хеш через отметки его палуб
+    for (int cy = top; cy <= bottom; cy++) {
+        for (int cx = left; cx <= right; cx++) {
+            int index = cellIndex(cx, cy);
+            hits.reset(index);
+            sunk.set(index);
+            hash ^= Zobrist::key(index, Zobrist::Hit) ^ Zobrist::key(index, Zobrist::Sunk);
+        }
+    }
+    
+    // клетки вокруг потопленного корабля точно пусты
+    for (int cy = std::max(top - 1, 0); cy <= std::min(bottom + 1, size - 1); cy++) {
+        for (int cx = std::max(left - 1, 0); cx <= std::min(right + 1, size - 1); cx++) {
+            int index = cellIndex(cx, cy);
+            if (!sunk.test(index)) {
+                setMiss(index);
+            }
+        }
+    }
+    
+    int length = std::max(right - left, bottom - top) + 1;
+    auto it = std::find(remainingShips.begin(), remainingShips.end(), length);
+    if (it != remainingShips.end()) {
+        remainingShips.erase(it);
+    }
+}
+
+bool Observation::isKnown(int x, int y) const {
+    int index = cellIndex(x, y);
+    return misses.test(index) || hits.test(index) || sunk.test(index);
+}
@@ -0,0 +1,48 @@
+#ifndef OBSERVATION_H
+#define OBSERVATION_H
+
+#include "Bitboard.h"
+#include "Zobrist.h"
+#include <vector>
+
+// то, что стреляющий знает о поле противника:
+// промахи, попадания по живым кораблям, потопленные корабли и оставшийся флот
+class Observation {
+private:
+    int size;
+    Bitboard misses;   // промахи и клетки вокруг потопленных - точно пусто
+    Bitboard hits;     // попадания по ещё не потопленным кораблям
+    Bitboard sunk;     // палубы потопленных кораблей
+    std::vector<int> remainingShips;  // длины непотопленных кораблей
+    uint64_t hash;     // хеш Зобриста известного состояния (поле, флот и все отметки)
+    
+    void setMiss(int index);
+    int cellIndex(int x, int y) const { return y * size + x; }
+    bool isValidPosition(int x, int y) const { return x >= 0 && x < size && y >= 0 && y < size; }
+    
+public:
+    Observation(int size, const std::vector<int>& fleet);
+    
+    void reset(const std::vector<int>& fleet);
+    
+    // регистрация результатов выстрелов
+    void recordMiss(int x, int y);
+    void recordHit(int x, int y);
+    // (x, y) - выстрел, потопивший корабль; корабль - линия попаданий через эту клетку
+    void recordDestroyed(int x, int y);
+    
+    // геттеры
+    int getSize() const { return size; }
+    const Bitboard& getMisses() const { return misses; }
+    const Bitboard& getHits() const { return hits; }
+    const Bitboard& getSunk() const { return sunk; }
+    const std::vector<int>& getRemainingShips() const { return remainingShips; }
+    
+    // одинаковое знание о поле даёт одинаковый хеш, в какой бы партии и каким путём оно ни было получено
+    uint64_t getHash() const { return hash; }
+    
+    // по клетке уже стреляли или она точно пуста
+    bool isKnown(int x, int y) const;
+};
+
+#endif
@@ -0,0 +1,79 @@
+#include "PlacementMasks.h"
+
+PlacementMasks::PlacementMasks(int size) 
+    : size(size), fullBoard(size * size), notFirstColumn(size * size), 
+      notLastColumn(size * size), rowScratch(size * size) {
+    for (int y = 0; y < size; y++) {
+        fullBoard.setRange(y * size, size);
+        for (int x = 0; x < size; x++) {
+            if (x > 0) notFirstColumn.set(y * size + x);
+            if (x < size - 1) notLastColumn.set(y * size + x);
+        }
+    }
+}
+
+void PlacementMasks::ensureLength(int length) {
+    // маски начал, при которых корабль длины length не выходит за поле
+    while (static_cast<int>(horizontalStarts.size()) <= length) {
+        int current = static_cast<int>(horizontalStarts.size());
+        Bitboard horizontalMask(size * size);
+        Bitboard verticalMask(size * size);
+        for (int y = 0; y < size; y++) {
+            for (int x = 0; x < size; x++) {
+                if (current > 0 && x + current <= size) horizontalMask.set(y * size + x);
+                // однопалубный корабль считается только горизонтальным
+                if (current > 1 && y + current <= size) verticalMask.set(y * size + x);
+            }
+        }
+        horizontalStarts.push_back(horizontalMask);
+        verticalStarts.push_back(verticalMask);
+    }
+}
+
+void PlacementMasks::dilate(const Bitboard& mask, Bitboard& result) const {
+    int words = mask.getWordCount();
+    
+    // сначала соседи по строке, затем по столбцу
+    Bitboard& row = rowScratch;
+    for (int i = 0; i < words; i++) {
+        row.setWord(i, mask.getWord(i) | 
+                       (mask.getWordShiftedUp(i, 1) & notFirstColumn.getWord(i)) | 
+                       (mask.getWordShiftedDown(i, 1) & notLastColumn.getWord(i)));
+    }
+    for (int i = 0; i < words; i++) {
+        result.setWord(i, (row.getWord(i) | row.getWordShiftedUp(i, size) | 
+                           row.getWordShiftedDown(i, size)) & fullBoard.getWord(i));
+    }
+}
+
+Bitboard PlacementMasks::dilate(const Bitboard& mask) const {
+    Bitboard result(size * size);
+    dilate(mask, result);
+    return result;
+}
+
+void PlacementMasks::legalStarts(const Bitboard& free, int length, bool vertical, Bitboard& starts) const {
+    const Bitboard& bounds = vertical ? verticalStarts[length] : horizontalStarts[length];
+    int stride = step(vertical);
+    int words = free.getWordCount();
+    
+    // начало допустимо, если свободны все length клеток от него
+    for (int i = 0; i < words; i++) {
+        uint64_t word = bounds.getWord(i) & free.getWord(i);
+        for (int k = 1; k < length && word; k++) {
+            word &= free.getWordShiftedDown(i, k * stride);
+        }
+        starts.setWord(i, word);
+    }
+}
+
+void PlacementMasks::shipMask(int start, int length, bool vertical, Bitboard& mask) const {
+    mask.clear();
+    if (vertical) {
+        for (int i = 0; i < length; i++) {
+            mask.set(start + i * size);
+        }
+    } else {
+        mask.setRange(start, length);
+    }
+}
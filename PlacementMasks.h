@@ -0,0 +1,49 @@
+#ifndef PLACEMENT_MASKS_H
+#define PLACEMENT_MASKS_H
+
+#include "Bitboard.h"
+#include <vector>
+
+// положение одного корабля
+struct Placement {
+    int x, y;
+    int size;
+    bool vertical;
+};
+
+// заранее посчитанные маски поля для поразрядного перебора положений кораблей
+class PlacementMasks {
+private:
+    int size;
+    Bitboard fullBoard;
+    Bitboard notFirstColumn;
+    Bitboard notLastColumn;
+    std::vector<Bitboard> horizontalStarts; // по длине: начала, при которых корабль в пределах поля
+    std::vector<Bitboard> verticalStarts;
+    mutable Bitboard rowScratch;
+    
+public:
+    explicit PlacementMasks(int size);
+    
+    int getSize() const { return size; }
+    const Bitboard& getFullBoard() const { return fullBoard; }
+    
+    // шаг индекса вдоль корабля
+    int step(bool vertical) const { return vertical ? size : 1; }
+    
+    // подготовить маски для кораблей длины до length включительно
+    void ensureLength(int length);
+    
+    // соседние клетки маски (8-связность) вместе с самой маской
+    void dilate(const Bitboard& mask, Bitboard& result) const;
+    Bitboard dilate(const Bitboard& mask) const;
+    
+    // начала положений длины length, все клетки которых лежат в free
+    // (маски для length должны быть подготовлены ensureLength)
+    void legalStarts(const Bitboard& free, int length, bool vertical, Bitboard& starts) const;
+    
+    // клетки корабля с началом start
+    void shipMask(int start, int length, bool vertical, Bitboard& mask) const;
+};
+
+#endif
@@ -1,8 +1,10 @@
 #include "Player.h"
+#include "FleetGenerator.h"
+#include "Random.h"
 #include <iostream>
 #include <algorithm>
-#include <random>
 #include <cctype>
+#include <functional>
 
 // AbstractPlayer
 
@@ -11,6 +13,9 @@ AbstractPlayer::AbstractPlayer() : name("Player"), shotsCount(0), hitsCount(0) {
 AbstractPlayer::AbstractPlayer(const std::string& name) 
     : name(name), shotsCount(0), hitsCount(0) {}
 
+AbstractPlayer::AbstractPlayer(const std::string& name, const BoardConfig& config) 
+    : name(name), field(config), shotsCount(0), hitsCount(0) {}
+
 double AbstractPlayer::getAccuracy() const {
     if (shotsCount == 0) return 0.0;
     return static_cast<double>(hitsCount) / shotsCount * 100.0;
@@ -22,6 +27,9 @@ HumanPlayer::HumanPlayer() : AbstractPlayer("Игрок") {}
 
 HumanPlayer::HumanPlayer(const std::string& name) : AbstractPlayer(name) {}
 
+HumanPlayer::HumanPlayer(const std::string& name, const BoardConfig& config) 
+    : AbstractPlayer(name, config) {}
+
 std::pair<int, int> HumanPlayer::makeMove() {
     std::string input;
     std::pair<int, int> coords;
@@ -32,12 +40,14 @@ std::pair<int, int> HumanPlayer::makeMove() {
         
         coords = parseInput(input);
         
-        if (coords. first >= 0 && coords.first < 10 && 
-            coords.second >= 0 && coords. second < 10) {
+        int size = field.getSize();
+        if (coords.first >= 0 && coords.first < size && 
+            coords.second >= 0 && coords.second < size) {
             return coords;
         }
         
-        std::cout << "Неверный формат!  Используйте букву (A-J или А-К) и цифру (1-10).\n";
+        std::cout << "Неверный формат!  Используйте букву (A-" << Field::columnLabel(size - 1) 
+                  << (size <= 10 ? " или А-К" : "") << ") и число (1-" << size << ").\n";
     }
 }
 
@@ -48,11 +58,17 @@ std::pair<int, int> HumanPlayer::parseInput(const std::string& input) const {
     int y = -1;
     
     // парсим букву (латиница или кириллица)
-    char letter = std::toupper(input[0]);
+    size_t numStart = 0;
     
-    // латинские буквы A-J
-    if (letter >= 'A' && letter <= 'J') {
-        x = letter - 'A';
+    // латинские буквы: A-Z, на больших полях дальше AA, AB, ... (как Field::columnLabel)
+    if (std::isalpha(static_cast<unsigned char>(input[0]))) {
+        x = 0;
+        while (numStart < input.length() && std::isalpha(static_cast<unsigned char>(input[numStart])) && 
+               x <= field.getSize()) {
+            x = x * 26 + (std::toupper(input[numStart]) - 'A' + 1);
+            numStart++;
+        }
+        x -= 1;
     }
     // русские буквы (UTF-8)
     else {
@@ -62,15 +78,11 @@ std::pair<int, int> HumanPlayer::parseInput(const std::string& input) const {
         if (pos != std::string::npos) {
             x = pos / 2;
         }
-    }
-    
-    // парсим число
-    size_t numStart = 1;
-    // для UTF-8 русских букв пропускаем 2 байта
-    if (input.length() > 1 && (unsigned char)input[0] > 127) {
+        // для UTF-8 русских букв пропускаем 2 байта
         numStart = 2;
     }
     
+    // парсим число
     if (numStart < input.length()) {
         try {
             y = std::stoi(input. substr(numStart)) - 1;
@@ -82,7 +94,7 @@ std::pair<int, int> HumanPlayer::parseInput(const std::string& input) const {
     return {x, y};
 }
 
-void HumanPlayer::placeShips() {
+bool HumanPlayer::placeShips() {
     std::cout << "\n=== Расстановка кораблей ===\n";
     std::cout << "Выберите способ:\n";
     std::cout << "1. Автоматическая расстановка\n";
@@ -93,7 +105,10 @@ void HumanPlayer::placeShips() {
     std::cin >> choice;
     
     if (choice == 1) {
-        field.placeAllShipsAuto();
+        if (!field.placeAllShipsAuto()) {
+            std::cout << "\nФлот не помещается на поле!\n";
+            return false;
+        }
         std::cout << "\nКорабли расставлены автоматически!\n";
         field.drawWithColors(false);
     } else {
@@ -104,12 +119,20 @@ void HumanPlayer::placeShips() {
             std::string name;
         };
         
-        std::vector<ShipInfo> shipsToPlace = {
-            {4, 1, "Линкор (4 палубы)"},
-            {3, 2, "Крейсер (3 палубы)"},
-            {2, 3, "Эсминец (2 палубы)"},
-            {1, 4, "Катер (1 палуба)"}
-        };
+        // корабли флота поля, от длинных к коротким
+        std::vector<ShipInfo> shipsToPlace;
+        std::vector<int> lengths(field.getFleet());
+        std::sort(lengths.begin(), lengths.end(), std::greater<int>());
+        lengths.erase(std::unique(lengths.begin(), lengths.end()), lengths.end());
+        for (int length : lengths) {
+            int count = static_cast<int>(std::count(field.getFleet().begin(), field.getFleet().end(), length));
+            int lastDigit = length % 10;
+            bool teen = length % 100 >= 11 && length % 100 <= 14;
+            std::string decks = (lastDigit == 1 && !teen) ? "палуба" : 
+                                (lastDigit >= 2 && lastDigit <= 4 && !teen) ? "палубы" : "палуб";
+            shipsToPlace.push_back({length, count, BoardConfig::shipName(length) + " (" + 
+                                    std::to_string(length) + " " + decks + ")"});
+        }
         
         for (const auto& shipInfo : shipsToPlace) {
             for (int i = 0; i < shipInfo.count; i++) {
@@ -146,50 +169,109 @@ void HumanPlayer::placeShips() {
         std::cout << "\nВсе корабли расставлены!\n";
         field.drawWithColors(false);
     }
+    return true;
 }
 
 // ComputerPlayer
 
-ComputerPlayer::ComputerPlayer() 
-    : AbstractPlayer("Компьютер"), lastHitX(-1), lastHitY(-1), isHunting(false) {
-    initAvailableCells();
-}
+ComputerPlayer::ComputerPlayer() : ComputerPlayer("Компьютер") {}
 
 ComputerPlayer::ComputerPlayer(const std::string& name) 
-    : AbstractPlayer(name), lastHitX(-1), lastHitY(-1), isHunting(false) {
+    : ComputerPlayer(name, TargetingStrategy::HuntTarget) {}
+
+ComputerPlayer::ComputerPlayer(const std::string& name, TargetingStrategy strategy) 
+    : ComputerPlayer(name, strategy, BoardConfig::standard()) {}
+
+ComputerPlayer::ComputerPlayer(const std::string& name, TargetingStrategy strategy, const BoardConfig& config) 
+    : AbstractPlayer(name, config), sampleShots(field.isSparse()), 
+      shotCells(sampleShots ? config.size * config.size : 0), shotCount(0),
+      priorityMask(config.size * config.size), lastHitX(-1), lastHitY(-1), isHunting(false), 
+      strategy(strategy), observation(config.size, config.fleet), rng(nullptr) {
+    priorityCells.reserve(MAX_PRIORITY_CELLS);
+    // подсчёт плотности идёт по всей площади, поэтому на разреженном поле не используется
+    if (strategy == TargetingStrategy::Density && !sampleShots) {
+        densityTargeting = std::make_unique<DensityTargeting>(config.size, config.maxShipLength());
+    }
     initAvailableCells();
 }
 
 void ComputerPlayer::initAvailableCells() {
-    availableCells.clear();
-    for (int y = 0; y < 10; y++) {
-        for (int x = 0; x < 10; x++) {
-            availableCells. push_back({x, y});
-        }
+    if (sampleShots) {
+        shotCells.clear();
+        shotCount = 0;
+        return;
+    }
+    
+    int cells = field.getSize() * field.getSize();
+    availableCells.resize(cells);
+    for (int i = 0; i < cells; i++) {
+        availableCells[i] = i;
     }
     
     // перемешиваем для случайного выбора
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::shuffle(availableCells.begin(), availableCells.end(), gen);
+    std::shuffle(availableCells.begin(), availableCells.end(), random());
+    
+    availablePosition.resize(cells);
+    for (int i = 0; i < cells; i++) {
+        availablePosition[availableCells[i]] = i;
+    }
+}
+
+bool ComputerPlayer::isAvailable(int cell) const {
+    return sampleShots ? !shotCells.test(cell) : availablePosition[cell] >= 0;
+}
+
+void ComputerPlayer::removeAvailable(int cell) {
+    if (sampleShots) {
+        if (!shotCells.test(cell)) {
+            shotCells.set(cell);
+            shotCount++;
+        }
+        return;
+    }
+    
+    int position = availablePosition[cell];
+    if (position < 0) return;
+    
+    // на место удаляемой ставим последнюю; перемешанный порядок остальных не страдает
+    int last = availableCells.back();
+    availableCells[position] = last;
+    availablePosition[last] = position;
+    availableCells.pop_back();
+    availablePosition[cell] = -1;
+}
+
+int ComputerPlayer::pickRandomCell() {
+    if (!sampleShots) {
+        return availableCells.empty() ? -1 : availableCells.back();
+    }
+    
+    // равновероятно среди необстрелянных: ожидаемое число попыток - площадь / число свободных
+    long long cells = static_cast<long long>(field.getSize()) * field.getSize();
+    if (shotCount >= cells) return -1;
+    Rng& generator = random();
+    int cell;
+    do {
+        cell = generator.below(static_cast<int>(cells));
+    } while (shotCells.test(cell));
+    return cell;
 }
 
 void ComputerPlayer::addPriorityCells(int x, int y) {
+    int size = field.getSize();
+    
     // добавляем соседние клетки в приоритет
-    std::vector<std::pair<int, int>> neighbors = {
+    const std::pair<int, int> neighbors[] = {
         {x - 1, y}, {x + 1, y}, {x, y - 1}, {x, y + 1}
     };
     
     for (const auto& n : neighbors) {
-        if (n. first >= 0 && n.first < 10 && n.second >= 0 && n.second < 10) {
-            // проверяем, что клетка ещё доступна
-            auto it = std::find(availableCells. begin(), availableCells.end(), n);
-            if (it != availableCells.end()) {
-                // проверяем, что её нет в приоритетных
-                auto pit = std::find(priorityCells. begin(), priorityCells.end(), n);
-                if (pit == priorityCells. end()) {
-                    priorityCells. push_back(n);
-                }
+        if (n.first >= 0 && n.first < size && n.second >= 0 && n.second < size) {
+            int cell = n.second * size + n.first;
+            // клетка ещё не обстреляна и её нет в приоритетных
+            if (isAvailable(cell) && !priorityMask.test(cell)) {
+                priorityMask.set(cell);
+                priorityCells.push_back(n);
             }
         }
     }
@@ -198,27 +280,68 @@ void ComputerPlayer::addPriorityCells(int x, int y) {
 std::pair<int, int> ComputerPlayer::makeMove() {
     std::pair<int, int> target;
     
-    if (! priorityCells.empty()) {
+    if (densityTargeting) {
+        // стреляем в клетку с наибольшей плотностью положений кораблей
+        int cell = densityTargeting->chooseTarget(observation, random());
+        if (cell >= 0) {
+            removeAvailable(cell);
+            return {cell % observation.getSize(), cell / observation.getSize()};
+        }
+    }
+    
+    int size = field.getSize();
+    if (!priorityCells.empty()) {
         // есть приоритетные клетки - добиваем корабль
         target = priorityCells.back();
-        priorityCells. pop_back();
-    } else if (!availableCells.empty()) {
-        // стреляем в случайную клетку
-        target = availableCells.back();
-        availableCells. pop_back();
+        priorityCells.pop_back();
+        priorityMask.reset(target.second * size + target.first);
     } else {
-        target = {0, 0};
+        // стреляем в случайную клетку
+        int cell = pickRandomCell();
+        if (cell < 0) {
+            // обстреляно всё поле - ходить некуда, поле отклонит ход как Invalid
+            return {-1, -1};
+        }
+        target = {cell % size, cell / size};
     }
     
     // удаляем из доступных
-    auto it = std::find(availableCells.begin(), availableCells.end(), target);
-    if (it != availableCells.end()) {
-        availableCells.erase(it);
-    }
+    removeAvailable(target.second * size + target.first);
     
     return target;
 }
 
+void ComputerPlayer::onAttackResult(int x, int y, Field::AttackResult result) {
+    switch (result) {
+        case Field::AttackResult::Miss:
+        case Field::AttackResult::AlreadyHit:
+            observation.recordMiss(x, y);
+            break;
+            
+        case Field::AttackResult::Hit:
+            observation.recordHit(x, y);
+            onHit(x, y);
+            break;
+            
+        case Field::AttackResult::Destroyed:
+            observation.recordDestroyed(x, y);
+            onDestroyed();
+            break;
+            
+        case Field::AttackResult::Invalid:
+            break;
+    }
+}
+
+void ComputerPlayer::clearPriorityCells() {
+    // сбрасываем только свои биты, без прохода по всему полю
+    int size = field.getSize();
+    for (const auto& cell : priorityCells) {
+        priorityMask.reset(cell.second * size + cell.first);
+    }
+    priorityCells.clear();
+}
+
 void ComputerPlayer::onHit(int x, int y) {
     isHunting = true;
     lastHitX = x;
@@ -228,16 +351,28 @@ void ComputerPlayer::onHit(int x, int y) {
 
 void ComputerPlayer::onDestroyed() {
     isHunting = false;
-    priorityCells.clear();
+    clearPriorityCells();
 }
 
-void ComputerPlayer::placeShips() {
-    field.placeAllShipsAuto();
+bool ComputerPlayer::placeShips() {
+    return field.placeAllShipsAuto();
+}
+
+void ComputerPlayer::setRng(Rng* generator) {
+    AbstractPlayer::setRng(generator);
+    rng = generator;
+}
+
+void ComputerPlayer::setTranspositionTable(TranspositionTable* table) {
+    if (densityTargeting) {
+        densityTargeting->setTranspositionTable(table);
+    }
 }
 
 void ComputerPlayer::reset() {
     initAvailableCells();
-    priorityCells.clear();
+    observation.reset(field.getFleet());
+    clearPriorityCells();
     lastHitX = -1;
     lastHitY = -1;
     isHunting = false;
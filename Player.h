@@ -2,7 +2,10 @@
 #define PLAYER_H
 
 #include "Field.h"
+#include "Observation.h"
+#include "Targeting.h"
 #include <string>
+#include <memory>
 #include <vector>
 #include <utility>
 
@@ -16,10 +19,13 @@ protected:
 public:
     AbstractPlayer();
     explicit AbstractPlayer(const std::string& name);
+    AbstractPlayer(const std::string& name, const BoardConfig& config);
     virtual ~AbstractPlayer() = default;
 
+    // {-1, -1} - необстрелянных клеток не осталось
     virtual std::pair<int, int> makeMove() = 0;
-    virtual void placeShips() = 0;
+    // false - флот целиком не поместился на поле
+    virtual bool placeShips() = 0;
     virtual bool isHuman() const = 0;
 
     Field& getField() { return field; }
@@ -29,8 +35,12 @@ public:
     int getHitsCount() const { return hitsCount; }
     void incrementShots() { shotsCount++; }
     void incrementHits() { hitsCount++; }
+    void resetCounters() { shotsCount = 0; hitsCount = 0; }
     double getAccuracy() const;
     
+    // генератор для расстановки и ходов, nullptr - генератор текущего потока
+    virtual void setRng(Rng* generator) { field.setRng(generator); }
+    
     bool hasLost() const { return field.allShipsDestroyed(); }
 };
 
@@ -38,9 +48,10 @@ class HumanPlayer : public AbstractPlayer {
 public:
     HumanPlayer();
     explicit HumanPlayer(const std::string& name);
+    HumanPlayer(const std::string& name, const BoardConfig& config);
     
     std::pair<int, int> makeMove() override;
-    void placeShips() override;
+    bool placeShips() override;
     bool isHuman() const override { return true; }
     
 private:
@@ -49,25 +60,60 @@ private:
 
 class ComputerPlayer : public AbstractPlayer {
 private:
-    std::vector<std::pair<int, int>> availableCells;
+    // запас под приоритетные клетки, чтобы ход не выделял память
+    static const int MAX_PRIORITY_CELLS = 64;
+    
+    // нетронутые клетки (индексы y * size + x) в случайном порядке;
+    // availablePosition[клетка] - её место в availableCells или -1,
+    // удаление - обмен с последней, поэтому любой ход стоит O(1)
+    std::vector<int> availableCells;
+    std::vector<int> availablePosition;
+    
+    // на разреженном поле списки по всем клеткам не заводятся: случайная клетка 
+    // выбирается с отбрасыванием уже обстрелянных (их мало по сравнению с площадью)
+    bool sampleShots;
+    Bitboard shotCells;
+    long long shotCount;
     std::vector<std::pair<int, int>> priorityCells;
+    Bitboard priorityMask;  // клетки, уже стоящие в priorityCells
     int lastHitX, lastHitY;
     bool isHunting;
     
+    TargetingStrategy strategy;
+    Observation observation;
+    std::unique_ptr<DensityTargeting> densityTargeting;
+    Rng* rng;
+    
+    Rng& random() const { return rng ? *rng : threadRng(); }
     void initAvailableCells();
+    bool isAvailable(int cell) const;
+    int pickRandomCell();
+    void removeAvailable(int cell);
     void addPriorityCells(int x, int y);
+    void clearPriorityCells();
     
 public:
     ComputerPlayer();
     explicit ComputerPlayer(const std::string& name);
+    ComputerPlayer(const std::string& name, TargetingStrategy strategy);
+    ComputerPlayer(const std::string& name, TargetingStrategy strategy, const BoardConfig& config);
     
     std::pair<int, int> makeMove() override;
-    void placeShips() override;
+    bool placeShips() override;
     bool isHuman() const override { return false; }
+    void setRng(Rng* generator) override;
     
+    // результат собственного выстрела: обновляет знания о поле противника
+    void onAttackResult(int x, int y, Field::AttackResult result);
     void onHit(int x, int y);
     void onDestroyed();
     void reset();
+    
+    TargetingStrategy getStrategy() const { return strategy; }
+    const Observation& getObservation() const { return observation; }
+    
+    // общая таблица транспозиций для стратегии плотности (у охоты кэшировать нечего)
+    void setTranspositionTable(TranspositionTable* table);
 };
 
 #endif
\ No newline at end of file
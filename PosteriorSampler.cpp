@@ -0,0 +1,501 @@
+#include "PosteriorSampler.h"
+#include <algorithm>
+#include <functional>
+
+PosteriorSampler::PosteriorSampler(int size)
+    : size(size), masks(size), allowed(size * size), hits(size * size),
+      occupied(size * size), ready(false), continued(false), others(size * size), freeCells(size * size),
+      uncovered(size * size), horizontal(size * size), vertical(size * size),
+      scratch(size * size), proposal(size * size), cover(size * size), horizontalCount(0),
+      pairProposals(0), pairAccepted(0), useMasks(size * size <= MAX_MASK_CELLS), fullMask(0),
+      notFirstColumnMask(0), notLastColumnMask(0), allowedMask(0), hitsMask(0), occupiedMask(0),
+      horizontalMask(0), verticalMask(0), tableLength(0) {
+    if (!useMasks) return;
+    for (int y = 0; y < size; y++) {
+        for (int x = 0; x < size; x++) {
+            Mask bit = Mask(1) << (y * size + x);
+            fullMask |= bit;
+            if (x > 0) notFirstColumnMask |= bit;
+            if (x < size - 1) notLastColumnMask |= bit;
+        }
+    }
+}
+
+void PosteriorSampler::setShipMask(Bitboard& mask, const Placement& placement) const {
+    masks.shipMask(placement.y * size + placement.x, placement.size, placement.vertical, mask);
+}
+
+void PosteriorSampler::computeFree(const Bitboard& ships) {
+    masks.dilate(ships, freeCells);
+    for (int i = 0; i < freeCells.getWordCount(); i++) {
+        freeCells.setWord(i, allowed.getWord(i) & ~freeCells.getWord(i));
+    }
+}
+
+int PosteriorSampler::computeCandidates(int length, const Bitboard* mustCover) {
+    int total = 0;
+    horizontalCount = 0;
+    for (int orientation = 0; orientation < 2; orientation++) {
+        bool isVertical = orientation == 1;
+        Bitboard& starts = isVertical ? vertical : horizontal;
+        if (isVertical && length == 1) {
+            // однопалубный корабль считается только горизонтальным
+            starts.clear();
+            break;
+        }
+        masks.legalStarts(freeCells, length, isVertical, starts);
+
+        // корабль, подбитый целиком, уже был бы потоплен
+        starts.andNot(fullyHit[length * 2 + orientation]);
+
+        // положение должно накрыть каждую клетку mustCover
+        if (mustCover) {
+            int stride = masks.step(isVertical);
+            mustCover->forEachSetBit([&](int cell) {
+                if (!starts.any()) return;
+                int rowStart = cell - cell % size;
+                scratch.clear();
+                for (int k = 0; k < length; k++) {
+                    int start = cell - k * stride;
+                    if (start < 0 || (!isVertical && start < rowStart)) break;
+                    scratch.set(start);
+                }
+                starts &= scratch;
+            });
+        }
+        int count = starts.count();
+        if (!isVertical) horizontalCount = count;
+        total += count;
+    }
+    return total;
+}
+
+void PosteriorSampler::pickCandidate(int total, int length, Rng& rng, Placement& result) {
+    int choice = rng.below(total);
+    bool isVertical = choice >= horizontalCount;
+    int start = isVertical ? vertical.select(choice - horizontalCount) : horizontal.select(choice);
+    result = {start % size, start / size, length, isVertical};
+}
+
+bool PosteriorSampler::search(int depth, Rng& rng, int& budget) {
+    int shipCount = static_cast<int>(fleet.size());
+    if (depth == shipCount) {
+        uncovered = hits;
+        uncovered.andNot(occupied);
+        return !uncovered.any();
+    }
+    if (--budget < 0) return false;
+
+    computeFree(occupied);
+    uncovered = hits;
+    uncovered.andNot(occupied);
+
+    std::vector<Option>& choices = options[depth];
+    choices.clear();
+
+    auto collect = [&](int ship, const Bitboard* mustCover) {
+        int length = fleet[ship];
+        if (computeCandidates(length, mustCover) == 0) return;
+        horizontal.forEachSetBit([&](int start) {
+            choices.push_back({ship, {start % size, start / size, length, false}});
+        });
+        vertical.forEachSetBit([&](int start) {
+            choices.push_back({ship, {start % size, start / size, length, true}});
+        });
+    };
+
+    if (uncovered.any()) {
+        // сначала накрываем первое ненакрытое попадание кораблём любой длины
+        cover.clear();
+        cover.set(uncovered.select(0));
+        for (int ship = 0; ship < shipCount; ship++) {
+            if (placed[ship]) continue;
+            // корабли одной длины взаимозаменяемы - пробуем только первый
+            bool duplicate = false;
+            for (int other = 0; other < ship; other++) {
+                if (!placed[other] && fleet[other] == fleet[ship]) duplicate = true;
+            }
+            if (!duplicate) collect(ship, &cover);
+        }
+    } else {
+        // все попадания накрыты: ставим следующий корабль куда угодно
+        int ship = 0;
+        while (placed[ship]) ship++;
+        collect(ship, nullptr);
+    }
+
+    std::shuffle(choices.begin(), choices.end(), rng);
+
+    for (size_t i = 0; i < choices.size(); i++) {
+        const Option option = options[depth][i];
+        layout[option.ship] = option.placement;
+        setShipMask(shipMasks[option.ship], option.placement);
+        occupied |= shipMasks[option.ship];
+        placed[option.ship] = true;
+
+        if (search(depth + 1, rng, budget)) return true;
+
+        occupied.andNot(shipMasks[option.ship]);
+        placed[option.ship] = false;
+        if (budget < 0) return false;
+    }
+    return false;
+}
+
+bool PosteriorSampler::continuesChain(const Bitboard& newAllowed, const Bitboard& newHits) {
+    // новые ограничения только сужают прежние
+    scratch = newAllowed;
+    scratch.andNot(allowed);
+    if (scratch.any()) return false;
+    scratch = hits;
+    scratch.andNot(newHits);
+    if (scratch.any()) return false;
+    
+    // текущая расстановка им удовлетворяет
+    scratch = occupied;
+    scratch.andNot(newAllowed);
+    if (scratch.any()) return false;
+    scratch = newHits;
+    scratch.andNot(occupied);
+    if (scratch.any()) return false;
+    for (size_t ship = 0; ship < fleet.size(); ship++) {
+        // на пути масок shipMasks не ведутся - обновляются здесь
+        setShipMask(shipMasks[ship], layout[ship]);
+        scratch = shipMasks[ship];
+        scratch.andNot(newHits);
+        if (!scratch.any()) return false;
+    }
+    return true;
+}
+
+bool PosteriorSampler::reset(const Observation& observation, Rng& rng) {
+    remaining = observation.getRemainingShips();
+    std::sort(remaining.begin(), remaining.end(), std::greater<int>());
+    for (int length : remaining) {
+        masks.ensureLength(length);
+    }
+
+    // корабли не стоят на промахах и не касаются потопленных
+    masks.dilate(observation.getSunk(), scratch);
+    proposal = masks.getFullBoard();
+    proposal.andNot(observation.getMisses());
+    proposal.andNot(scratch);
+    
+    // множество согласованных расстановок только сузилось, и текущая в нём осталась:
+    // равномерная по прежнему множеству расстановка, попавшая в подмножество, равномерна
+    // и на нём, поэтому цепь продолжается без поиска и разгона
+    continued = ready && remaining == fleet && continuesChain(proposal, observation.getHits());
+    fleet = remaining;
+    allowed = proposal;
+    hits = observation.getHits();
+    
+    int maxLength = fleet.empty() ? 0 : fleet.front();
+    fullyHit.assign((maxLength + 1) * 2, Bitboard(size * size));
+    for (int length = 1; length <= maxLength; length++) {
+        masks.legalStarts(hits, length, false, fullyHit[length * 2]);
+        masks.legalStarts(hits, length, true, fullyHit[length * 2 + 1]);
+    }
+
+    pairProposals = 0;
+    pairAccepted = 0;
+    if (continued) {
+        if (useMasks) loadMasks();
+        return true;
+    }
+
+    int shipCount = static_cast<int>(fleet.size());
+    layout.resize(shipCount);
+    shipMasks.assign(shipCount, Bitboard(size * size));
+    placed.assign(shipCount, false);
+    options.resize(shipCount);
+    occupied.clear();
+
+    int budget = MAX_BACKTRACKS;
+    ready = search(0, rng, budget);
+    if (ready && useMasks) loadMasks();
+
+    // поиск в глубину смещён к первым найденным вариантам - уводим цепь от них
+    for (int sweep = 0; ready && sweep < BURN_IN_SWEEPS; sweep++) {
+        step(rng);
+    }
+    return ready;
+}
+
+void PosteriorSampler::relocate(int ship, Rng& rng) {
+    // корабли не пересекаются, поэтому остальные = все без текущего
+    others = occupied;
+    others.andNot(shipMasks[ship]);
+    computeFree(others);
+
+    // попадания, не накрытые остальными, обязан накрыть этот корабль
+    uncovered = hits;
+    uncovered.andNot(others);
+
+    // текущее положение всегда допустимо, поэтому выбор непуст
+    int total = computeCandidates(fleet[ship], uncovered.any() ? &uncovered : nullptr);
+    if (total > 0) {
+        pickCandidate(total, fleet[ship], rng, layout[ship]);
+        setShipMask(shipMasks[ship], layout[ship]);
+    }
+    occupied = others;
+    occupied |= shipMasks[ship];
+}
+
+void PosteriorSampler::relocatePair(int first, int second, Rng& rng) {
+    // предложение: first - равновероятно среди положений при остальных,
+    // second - равновероятно среди допустимых при новом first;
+    // приём с вероятностью min(1, N_new / N_old), где N - число вариантов для second
+    others = occupied;
+    others.andNot(shipMasks[first]);
+    others.andNot(shipMasks[second]);
+    uncovered = hits;
+    uncovered.andNot(others);
+
+    // N_old: варианты second при текущем first
+    proposal = others;
+    proposal |= shipMasks[first];
+    computeFree(proposal);
+    cover = uncovered;
+    cover.andNot(shipMasks[first]);
+    int oldCount = computeCandidates(fleet[second], cover.any() ? &cover : nullptr);
+
+    // новое положение first
+    computeFree(others);
+    int firstCount = computeCandidates(fleet[first], nullptr);
+    if (firstCount == 0) return;
+    Placement firstPlacement;
+    pickCandidate(firstCount, fleet[first], rng, firstPlacement);
+
+    // N_new: варианты second при новом first
+    pairProposals++;
+    setShipMask(proposal, firstPlacement);
+    cover = uncovered;
+    cover.andNot(proposal);
+    proposal |= others;
+    computeFree(proposal);
+    int newCount = computeCandidates(fleet[second], cover.any() ? &cover : nullptr);
+    if (newCount == 0) return;
+    if (newCount < oldCount && rng.below(oldCount) >= newCount) return;
+
+    pairAccepted++;
+    layout[first] = firstPlacement;
+    setShipMask(shipMasks[first], firstPlacement);
+    pickCandidate(newCount, fleet[second], rng, layout[second]);
+    setShipMask(shipMasks[second], layout[second]);
+
+    occupied = others;
+    occupied |= shipMasks[first];
+    occupied |= shipMasks[second];
+}
+
+void PosteriorSampler::step(Rng& rng) {
+    if (!ready) return;
+
+    int shipCount = static_cast<int>(fleet.size());
+    for (int ship = 0; ship < shipCount; ship++) {
+        if (useMasks) {
+            relocateMasked(ship, rng);
+        } else {
+            relocate(ship, rng);
+        }
+    }
+
+    // одиночные перевыборы не переносят попадание с корабля на корабль - это делают
+    // только парные ходы, и по одному на проход цепь из начальной расстановки сходится медленно
+    for (int pair = 0; pair < shipCount && shipCount >= 2; pair++) {
+        int first = rng.below(shipCount);
+        int second = rng.below(shipCount - 1);
+        if (second >= first) second++;
+        if (useMasks) {
+            relocatePairMasked(first, second, rng);
+        } else {
+            relocatePair(first, second, rng);
+        }
+    }
+    
+    if (useMasks) {
+        occupied.setWord(0, static_cast<uint64_t>(occupiedMask));
+        if (occupied.getWordCount() > 1) occupied.setWord(1, static_cast<uint64_t>(occupiedMask >> 64));
+    }
+}
+
+void PosteriorSampler::accumulate(int samples, Rng& rng, std::vector<int>& counts) {
+    counts.resize(size * size, 0);
+    if (!ready) return;
+
+    for (int i = 0; i < samples; i++) {
+        step(rng);
+        occupied.forEachSetBit([&](int cell) { counts[cell]++; });
+    }
+}
+
+// 128-битные маски
+
+PosteriorSampler::Mask PosteriorSampler::toMask(const Bitboard& board) {
+    Mask mask = board.getWord(0);
+    if (board.getWordCount() > 1) mask |= static_cast<Mask>(board.getWord(1)) << 64;
+    return mask;
+}
+
+int PosteriorSampler::wordCount(uint64_t word) {
+#ifdef __POPCNT__
+    return __builtin_popcountll(word);
+#else
+    // без инструкции popcnt встроенная функция - вызов библиотеки, подсчёт по байтам быстрее
+    word = word - ((word >> 1) & 0x5555555555555555ULL);
+    word = (word & 0x3333333333333333ULL) + ((word >> 2) & 0x3333333333333333ULL);
+    word = (word + (word >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return static_cast<int>((word * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+int PosteriorSampler::maskCount(Mask mask) {
+    uint64_t high = static_cast<uint64_t>(mask >> 64);
+    return wordCount(static_cast<uint64_t>(mask)) + (high ? wordCount(high) : 0);
+}
+
+void PosteriorSampler::ensureTables(int length) {
+    if (length <= tableLength) return;
+    int cells = size * size;
+    shipTable.assign(static_cast<size_t>(length + 1) * 2 * cells, 0);
+    coverTable.assign(static_cast<size_t>(length + 1) * 2 * cells, 0);
+    for (int shipLength = 1; shipLength <= length; shipLength++) {
+        for (int orientation = 0; orientation < 2; orientation++) {
+            bool isVertical = orientation == 1;
+            int stride = masks.step(isVertical);
+            Mask* ships = &shipTable[static_cast<size_t>(shipLength * 2 + orientation) * cells];
+            Mask* covers = &coverTable[static_cast<size_t>(shipLength * 2 + orientation) * cells];
+            for (int cell = 0; cell < cells; cell++) {
+                int rowStart = cell - cell % size;
+                for (int k = 0; k < shipLength; k++) {
+                    // корабль с началом в cell (за край поля - обрезается, такие начала не выбираются)
+                    int deck = cell + k * stride;
+                    if (deck < cells && (isVertical || deck < rowStart + size)) ships[cell] |= Mask(1) << deck;
+                    // начало, с которого корабль накрывает cell
+                    int start = cell - k * stride;
+                    if (start >= 0 && (isVertical || start >= rowStart)) covers[cell] |= Mask(1) << start;
+                }
+            }
+        }
+    }
+    tableLength = length;
+}
+
+PosteriorSampler::Mask PosteriorSampler::maskFree(Mask ships) const {
+    // соседи по строке, затем по столбцу - как PlacementMasks::dilate
+    Mask row = ships | ((ships << 1) & notFirstColumnMask) | ((ships >> 1) & notLastColumnMask);
+    Mask dilated = (row | (row << size) | (row >> size)) & fullMask;
+    return allowedMask & ~dilated;
+}
+
+PosteriorSampler::Mask PosteriorSampler::maskShip(const Placement& placement) const {
+    size_t row = static_cast<size_t>(placement.size * 2 + (placement.vertical ? 1 : 0)) * size * size;
+    return shipTable[row + placement.y * size + placement.x];
+}
+
+int PosteriorSampler::maskCandidates(int length, Mask free, Mask mustCover) {
+    Mask starts[2];
+    for (int orientation = 0; orientation < 2; orientation++) {
+        bool isVertical = orientation == 1;
+        int stride = masks.step(isVertical);
+        // у однопалубного корабля вертикальных начал нет - маска пуста
+        Mask word = startMasks[length * 2 + orientation] & free;
+        for (int k = 1; k < length && word; k++) {
+            word &= free >> (k * stride);
+        }
+        
+        // положение должно накрыть каждую клетку mustCover
+        const Mask* covers = &coverTable[static_cast<size_t>(length * 2 + orientation) * size * size];
+        for (Mask cells = mustCover; cells && word; cells &= cells - 1) {
+            uint64_t low = static_cast<uint64_t>(cells);
+            word &= covers[low ? __builtin_ctzll(low) : 64 + __builtin_ctzll(static_cast<uint64_t>(cells >> 64))];
+        }
+        starts[orientation] = word;
+    }
+    horizontalMask = starts[0];
+    verticalMask = starts[1];
+    horizontalCount = maskCount(horizontalMask);
+    return horizontalCount + maskCount(verticalMask);
+}
+
+void PosteriorSampler::maskPick(int total, int length, Rng& rng, Placement& result) {
+    int choice = rng.below(total);
+    bool isVertical = choice >= horizontalCount;
+    Mask starts = isVertical ? verticalMask : horizontalMask;
+    int k = isVertical ? choice - horizontalCount : choice;
+    
+    uint64_t low = static_cast<uint64_t>(starts);
+    int lowCount = wordCount(low);
+    int start = k < lowCount ? Bitboard::selectInWord(low, k) 
+                             : 64 + Bitboard::selectInWord(static_cast<uint64_t>(starts >> 64), k - lowCount);
+    result = {start % size, start / size, length, isVertical};
+}
+
+void PosteriorSampler::loadMasks() {
+    allowedMask = toMask(allowed);
+    hitsMask = toMask(hits);
+    occupiedMask = toMask(occupied);
+    
+    int maxLength = fleet.empty() ? 0 : fleet.front();
+    ensureTables(maxLength);
+    startMasks.assign((maxLength + 1) * 2, 0);
+    for (int length = 1; length <= maxLength; length++) {
+        for (int orientation = 0; orientation < 2; orientation++) {
+            masks.legalStarts(masks.getFullBoard(), length, orientation == 1, scratch);
+            startMasks[length * 2 + orientation] = toMask(scratch) & ~toMask(fullyHit[length * 2 + orientation]);
+        }
+    }
+    
+    shipMaskBits.resize(fleet.size());
+    for (size_t ship = 0; ship < fleet.size(); ship++) {
+        shipMaskBits[ship] = toMask(shipMasks[ship]);
+    }
+}
+
+void PosteriorSampler::relocateMasked(int ship, Rng& rng) {
+    Mask others = occupiedMask & ~shipMaskBits[ship];
+    int total = maskCandidates(fleet[ship], maskFree(others), hitsMask & ~others);
+    if (total > 0) {
+        maskPick(total, fleet[ship], rng, layout[ship]);
+        shipMaskBits[ship] = maskShip(layout[ship]);
+    }
+    occupiedMask = others | shipMaskBits[ship];
+}
+
+void PosteriorSampler::relocatePairMasked(int first, int second, Rng& rng) {
+    // тот же ход, что relocatePair, но N_old считается последним: примерно треть
+    // предложений отвергается ещё при N_new = 0 (генератор расходуется так же)
+    Mask others = occupiedMask & ~shipMaskBits[first] & ~shipMaskBits[second];
+    Mask uncoveredHits = hitsMask & ~others;
+    
+    int firstCount = maskCandidates(fleet[first], maskFree(others), 0);
+    if (firstCount == 0) return;
+    Placement firstPlacement;
+    maskPick(firstCount, fleet[first], rng, firstPlacement);
+    
+    pairProposals++;
+    Mask firstMask = maskShip(firstPlacement);
+    int newCount = maskCandidates(fleet[second], maskFree(others | firstMask), uncoveredHits & ~firstMask);
+    if (newCount == 0) return;
+    Mask newHorizontal = horizontalMask;
+    Mask newVertical = verticalMask;
+    int newHorizontalCount = horizontalCount;
+    
+    Mask withFirst = others | shipMaskBits[first];
+    int oldCount = maskCandidates(fleet[second], maskFree(withFirst), uncoveredHits & ~shipMaskBits[first]);
+    if (newCount < oldCount && rng.below(oldCount) >= newCount) return;
+    
+    pairAccepted++;
+    layout[first] = firstPlacement;
+    shipMaskBits[first] = firstMask;
+    horizontalMask = newHorizontal;
+    verticalMask = newVertical;
+    horizontalCount = newHorizontalCount;
+    maskPick(newCount, fleet[second], rng, layout[second]);
+    shipMaskBits[second] = maskShip(layout[second]);
+    occupiedMask = others | shipMaskBits[first] | shipMaskBits[second];
+}
+
+double PosteriorSampler::getPairAcceptance() const {
+    return pairProposals > 0 ? static_cast<double>(pairAccepted) / pairProposals : 0.0;
+}
@@ -0,0 +1,143 @@
+#ifndef POSTERIOR_SAMPLER_H
+#define POSTERIOR_SAMPLER_H
+
+#include "Observation.h"
+#include "PlacementMasks.h"
+#include "Random.h"
+#include <vector>
+
+// выборка расстановок оставшегося флота, согласованных с наблюдением:
+// корабли не стоят на промахах и потопленных, не касаются друг друга
+// и потопленных, накрывают все попадания, и ни один не подбит целиком
+//
+// цепь Маркова по допустимым расстановкам: проход Гиббса перевыбирает
+// каждый корабль среди положений, допустимых при остальных, а парный ход
+// (Метрополис-Гастингс) перекладывает два корабля разом, чтобы попадание
+// могло перейти от одного корабля к другому; стационарное распределение -
+// равномерное по согласованным расстановкам
+//
+// на поле до 11x11 (не больше 128 клеток) шаги цепи идут на 128-битных масках
+// без циклов по словам доски; генератор расходуется так же, как на общем пути,
+// поэтому цепь с тем же зерном проходит те же расстановки
+class PosteriorSampler {
+private:
+    // предел откатов при поиске начальной расстановки
+    static const int MAX_BACKTRACKS = 20000;
+    // шагов после поиска: поиск сильно смещён, на 5x5 (simulate uniformity)
+    // после 64 шагов частоты согласуются с полным перебором
+    static const int BURN_IN_SWEEPS = 64;
+    static const int MAX_MASK_CELLS = 128;
+    
+    typedef unsigned __int128 Mask;
+
+    // вариант хода при поиске: корабль и его положение
+    struct Option {
+        int ship;
+        Placement placement;
+    };
+
+    int size;
+    PlacementMasks masks;
+    std::vector<int> fleet;  // длины оставшихся кораблей по убыванию
+    std::vector<int> remaining;  // то же по новому наблюдению в reset
+
+    // ограничения наблюдения
+    Bitboard allowed;  // клетки, где может стоять оставшийся корабль
+    Bitboard hits;     // попадания, которые должны быть накрыты
+    std::vector<Bitboard> fullyHit;  // [length * 2 + vertical]: начала положений целиком на попаданиях
+
+    // текущая расстановка
+    std::vector<Placement> layout;
+    std::vector<Bitboard> shipMasks;
+    Bitboard occupied;
+    bool ready;
+    bool continued;  // последний reset продолжил цепь
+
+    // рабочее состояние, переиспользуется между вызовами
+    Bitboard others;
+    Bitboard freeCells;
+    Bitboard uncovered;
+    Bitboard horizontal;
+    Bitboard vertical;
+    Bitboard scratch;
+    Bitboard proposal;
+    Bitboard cover;
+    int horizontalCount;  // число горизонтальных кандидатов после computeCandidates
+    std::vector<bool> placed;
+    std::vector<std::vector<Option>> options;  // по глубине поиска
+    long long pairProposals;
+    long long pairAccepted;
+    
+    // то же на 128-битных масках; shipMasks и occupied на Bitboard при этом не ведутся,
+    // occupied переписывается в конце шага
+    bool useMasks;
+    Mask fullMask;
+    Mask notFirstColumnMask;
+    Mask notLastColumnMask;
+    Mask allowedMask;
+    Mask hitsMask;
+    Mask occupiedMask;
+    Mask horizontalMask;           // кандидаты после maskCandidates
+    Mask verticalMask;
+    std::vector<Mask> startMasks;  // [length * 2 + vertical]: начала в пределах поля, кроме подбитых целиком
+    std::vector<Mask> shipMaskBits;
+    // [(length * 2 + vertical) * клеток + клетка]: клетки корабля с началом в клетке
+    // и начала положений, накрывающих клетку; длины до tableLength
+    std::vector<Mask> shipTable;
+    std::vector<Mask> coverTable;
+    int tableLength;
+
+    void setShipMask(Bitboard& mask, const Placement& placement) const;
+    void computeFree(const Bitboard& ships);
+    // начала допустимых положений в horizontal/vertical, возвращает их число
+    int computeCandidates(int length, const Bitboard* mustCover);
+    void pickCandidate(int total, int length, Rng& rng, Placement& result);
+    bool search(int depth, Rng& rng, int& budget);
+    // новые ограничения сужают текущие и выполнены текущей расстановкой
+    bool continuesChain(const Bitboard& newAllowed, const Bitboard& newHits);
+    void relocate(int ship, Rng& rng);
+    void relocatePair(int first, int second, Rng& rng);
+    
+    static Mask toMask(const Bitboard& board);
+    static int wordCount(uint64_t word);
+    static int maskCount(Mask mask);
+    void ensureTables(int length);
+    Mask maskFree(Mask ships) const;
+    Mask maskShip(const Placement& placement) const;
+    int maskCandidates(int length, Mask free, Mask mustCover);
+    void maskPick(int total, int length, Rng& rng, Placement& result);
+    void loadMasks();
+    void relocateMasked(int ship, Rng& rng);
+    void relocatePairMasked(int first, int second, Rng& rng);
+
+public:
+    explicit PosteriorSampler(int size);
+
+    int getSize() const { return size; }
+
+    // принять наблюдение и найти начальную согласованную расстановку;
+    // false - согласованных расстановок нет (или не найдена за предел откатов);
+    // если наблюдение лишь добавило промахи и попадания к прошлому и текущая расстановка
+    // с ними согласна, цепь продолжается с неё без поиска и разгона
+    bool reset(const Observation& observation, Rng& rng);
+    bool isReady() const { return ready; }
+    bool isContinued() const { return continued; }
+    // следующий reset начнёт с поиска, даже если мог бы продолжить цепь
+    void discardChain() { ready = false; }
+
+    // один шаг цепи: проход Гиббса по всем кораблям и по парному ходу на корабль
+    void step(Rng& rng);
+
+    // текущая расстановка (длины в getFleet) и её клетки
+    const std::vector<int>& getFleet() const { return fleet; }
+    const std::vector<Placement>& getLayout() const { return layout; }
+    const Bitboard& getOccupied() const { return occupied; }
+
+    // samples шагов цепи; counts[y * size + x] += число выборок с кораблём в клетке
+    void accumulate(int samples, Rng& rng, std::vector<int>& counts);
+
+    // доля принятых парных ходов
+    double getPairAcceptance() const;
+};
+
+#endif
@@ -0,0 +1,47 @@
+#include "Random.h"
+#include <random>
+
+namespace {
+    uint64_t splitmix(uint64_t& x) {
+        uint64_t z = (x += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+    
+    struct ThreadRngState {
+        Rng engine;
+        
+        ThreadRngState() {
+            std::random_device rd;
+            engine.seed((static_cast<uint64_t>(rd()) << 32) | rd());
+        }
+    };
+    
+    ThreadRngState& state() {
+        thread_local ThreadRngState instance;
+        return instance;
+    }
+}
+
+void Rng::seed(uint64_t seed) {
+    for (auto& word : state) {
+        word = splitmix(seed);
+    }
+}
+
+Rng Rng::forStream(uint64_t seed, uint64_t stream) {
+    // номер потока перемешивается с зерном, соседние номера дают несвязанные состояния
+    uint64_t mixed = seed;
+    splitmix(mixed);
+    mixed ^= stream * 0xD1B54A32D192ED03ULL;
+    return Rng(splitmix(mixed));
+}
+
+Rng& threadRng() {
+    return state().engine;
+}
+
+void seedThreadRng(uint64_t seed) {
+    state().engine.seed(seed);
+}
@@ -0,0 +1,57 @@
+#ifndef RANDOM_H
+#define RANDOM_H
+
+#include <cstdint>
+#include <limits>
+
+// быстрый генератор xoshiro256** (Блэкман, Винья)
+// подходит для std::uniform_int_distribution и std::shuffle;
+// состояние - 4 слова, одно зерно задаёт всю последовательность бит в бит
+class Rng {
+private:
+    uint64_t state[4];
+    
+    static uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+    
+public:
+    using result_type = uint64_t;
+    
+    explicit Rng(uint64_t seed = 0) { this->seed(seed); }
+    
+    // зерно разворачивается в состояние через splitmix64, поэтому годится любое, включая 0
+    void seed(uint64_t seed);
+    
+    // независимый поток номер stream для зерна seed: у каждого потока исполнения
+    // или задачи своя последовательность, не зависящая от порядка их запуска
+    static Rng forStream(uint64_t seed, uint64_t stream);
+    
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+    
+    result_type operator()() {
+        uint64_t result = rotl(state[1] * 5, 7) * 9;
+        uint64_t shifted = state[1] << 17;
+        state[2] ^= state[0];
+        state[3] ^= state[1];
+        state[1] ^= state[2];
+        state[0] ^= state[3];
+        state[2] ^= shifted;
+        state[3] = rotl(state[3], 45);
+        return result;
+    }
+    
+    // число от 0 до n - 1 умножением старших 32 бит без деления
+    // (смещение порядка n / 2^32, для размеров поля несущественно)
+    int below(int n) {
+        return static_cast<int>(((*this)() >> 32) * static_cast<uint64_t>(n) >> 32);
+    }
+};
+
+// генератор текущего потока - источник по умолчанию для полей и игроков без своего генератора
+// засевается из std::random_device один раз при первом обращении
+Rng& threadRng();
+
+// явная установка зерна генератора текущего потока
+void seedThreadRng(uint64_t seed);
+
+#endif
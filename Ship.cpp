@@ -29,18 +29,6 @@ char AbstractShip::getSymbol() const {
     return isDestroyed() ? '#' : 'O';
 }
 
-std::vector<std::pair<int, int>> AbstractShip::getDecksCoordinates() const {
-    std::vector<std::pair<int, int>> coords;
-    for (int i = 0; i < size; i++) {
-        if (isVertical) {
-            coords. push_back({x, y + i});
-        } else {
-            coords.push_back({x + i, y});
-        }
-    }
-    return coords;
-}
-
 // Ship
 
 Ship::Ship() : AbstractShip(), id(nextId++) {}
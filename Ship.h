@@ -4,6 +4,51 @@
 #include "Cell.h"
 #include <vector>
 #include <string>
+#include <utility>
+#include <type_traits>
+
+// палубы корабля как диапазон координат, без выделения памяти:
+// for (std::pair<int, int> deck : ship.getDecksCoordinates()) ...
+class DeckRange {
+private:
+    int x, y, size;
+    bool vertical;
+    
+public:
+    class iterator {
+    private:
+        int x, y, i;
+        bool vertical;
+        
+    public:
+        iterator(int x, int y, int i, bool vertical) : x(x), y(y), i(i), vertical(vertical) {}
+        
+        std::pair<int, int> operator*() const { return vertical ? std::make_pair(x, y + i) : std::make_pair(x + i, y); }
+        iterator& operator++() { i++; return *this; }
+        bool operator!=(const iterator& other) const { return i != other.i; }
+    };
+    
+    DeckRange(int x, int y, int size, bool vertical) : x(x), y(y), size(size), vertical(vertical) {}
+    
+    iterator begin() const { return iterator(x, y, 0, vertical); }
+    iterator end() const { return iterator(x, y, size, vertical); }
+    int count() const { return size; }
+};
+
+// корабль на поле: простые данные без виртуальных функций и строк,
+// массив таких записей копируется и очищается без выделения памяти;
+// попадания хранит поле, запись описывает только положение
+struct ShipRecord {
+    int x, y;
+    int size;
+    bool vertical;
+    
+    static ShipRecord make(int x, int y, int size, bool vertical) { return ShipRecord{x, y, size, vertical}; }
+    
+    DeckRange getDecksCoordinates() const { return DeckRange(x, y, size, vertical); }
+};
+
+static_assert(std::is_trivially_copyable<ShipRecord>::value, "ShipRecord копируется memcpy");
 
 // абстрактный базовый класс корабля
 class AbstractShip : public GameObject {
@@ -45,8 +90,8 @@ public:
     // статический метод
     static int getTotalShipsCreated() { return totalShipsCreated; }
     
-    // получение координат всех палуб
-    std::vector<std::pair<int, int>> getDecksCoordinates() const;
+    // координаты всех палуб корабля (диапазон, без выделения памяти)
+    DeckRange getDecksCoordinates() const { return DeckRange(x, y, size, isVertical); }
 };
 
 // конкретный класс корабля
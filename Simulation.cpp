@@ -0,0 +1,104 @@
+#include "Simulation.h"
+#include <chrono>
+#include <iomanip>
+
+// SimulationStats
+
+SimulationStats::SimulationStats() 
+    : games(0), player1Wins(0), player2Wins(0), winnerShots(0), unplayed(0), seconds(0.0) {}
+
+void SimulationStats::add(const GameResult& result) {
+    if (result.winner == 0) {
+        unplayed++;
+        return;
+    }
+    
+    games++;
+    if (result.winner == 1) {
+        player1Wins++;
+    } else {
+        player2Wins++;
+    }
+    winnerShots += result.winnerShots();
+}
+
+void SimulationStats::merge(const SimulationStats& other) {
+    games += other.games;
+    player1Wins += other.player1Wins;
+    player2Wins += other.player2Wins;
+    winnerShots += other.winnerShots;
+    unplayed += other.unplayed;
+}
+
+double SimulationStats::gamesPerSecond() const {
+    if (seconds <= 0.0) return 0.0;
+    return games / seconds;
+}
+
+double SimulationStats::averageShotsToWin() const {
+    if (games == 0) return 0.0;
+    return static_cast<double>(winnerShots) / games;
+}
+
+double SimulationStats::player1WinRatio() const {
+    if (games == 0) return 0.0;
+    return static_cast<double>(player1Wins) / games;
+}
+
+double SimulationStats::player2WinRatio() const {
+    if (games == 0) return 0.0;
+    return static_cast<double>(player2Wins) / games;
+}
+
+// HeadlessSimulator
+
+HeadlessSimulator::HeadlessSimulator(TargetingStrategy player1Strategy, TargetingStrategy player2Strategy, 
+                                     const BoardConfig& config) 
+    : game(player1Strategy, player2Strategy, config), writer(nullptr) {}
+
+void HeadlessSimulator::setRecordWriter(GameRecordWriter* recordWriter) {
+    writer = recordWriter;
+    game.setRecord(writer ? &record : nullptr);
+}
+
+SimulationStats HeadlessSimulator::run(long long games) {
+    SimulationStats stats;
+    
+    auto start = std::chrono::steady_clock::now();
+    for (long long i = 0; i < games; i++) {
+        GameResult result = game.runHeadless();
+        stats.add(result);
+        if (writer && result.winner != 0) writer->write(record);
+    }
+    auto finish = std::chrono::steady_clock::now();
+    
+    stats.seconds = std::chrono::duration<double>(finish - start).count();
+    return stats;
+}
+
+void printReport(std::ostream& os, const SimulationStats& stats) {
+    os << std::fixed << std::setprecision(3);
+    os << "Партий сыграно:        " << stats.games << "\n";
+    if (stats.unplayed > 0) {
+        os << "Не сыграно:            " << stats.unplayed << " (флот не помещается на поле)\n";
+    }
+    os << "Время, с:              " << stats.seconds << "\n";
+    os << "Партий в секунду:      " << std::setprecision(1) << stats.gamesPerSecond() << "\n";
+    os << "Выстрелов до победы:   " << std::setprecision(2) << stats.averageShotsToWin() << "\n";
+    os << "Побед игрока 1:        " << stats.player1Wins 
+       << " (" << std::setprecision(1) << stats.player1WinRatio() * 100.0 << "%)\n";
+    os << "Побед игрока 2:        " << stats.player2Wins 
+       << " (" << std::setprecision(1) << stats.player2WinRatio() * 100.0 << "%)\n";
+}
+
+bool parseStrategy(const std::string& name, TargetingStrategy& strategy) {
+    if (name == "hunt") {
+        strategy = TargetingStrategy::HuntTarget;
+        return true;
+    }
+    if (name == "density") {
+        strategy = TargetingStrategy::Density;
+        return true;
+    }
+    return false;
+}
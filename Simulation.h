@@ -0,0 +1,53 @@
+#ifndef SIMULATION_H
+#define SIMULATION_H
+
+#include "Game.h"
+#include <iostream>
+
+// накопленная статистика серии партий
+struct SimulationStats {
+    long long games;
+    long long player1Wins;
+    long long player2Wins;
+    long long winnerShots;
+    long long unplayed;  // флот не поместился на поле
+    double seconds;
+    
+    SimulationStats();
+    
+    void add(const GameResult& result);
+    void merge(const SimulationStats& other);
+    
+    double gamesPerSecond() const;
+    double averageShotsToWin() const;
+    double player1WinRatio() const;
+    double player2WinRatio() const;
+};
+
+// пакетный прогон партий компьютер против компьютера без ввода-вывода
+class HeadlessSimulator {
+private:
+    Game game;
+    GameRecord record;
+    GameRecordWriter* writer;
+    
+public:
+    HeadlessSimulator(TargetingStrategy player1Strategy = TargetingStrategy::HuntTarget,
+                      TargetingStrategy player2Strategy = TargetingStrategy::HuntTarget,
+                      const BoardConfig& config = BoardConfig());
+    
+    // сыграть games партий подряд
+    SimulationStats run(long long games);
+    
+    void setTranspositionTable(TranspositionTable* table) { game.setTranspositionTable(table); }
+    
+    // каждая сыгранная партия дописывается в writer, nullptr - без записи
+    void setRecordWriter(GameRecordWriter* recordWriter);
+};
+
+void printReport(std::ostream& os, const SimulationStats& stats);
+
+// разбор названия стратегии ("hunt", "density")
+bool parseStrategy(const std::string& name, TargetingStrategy& strategy);
+
+#endif
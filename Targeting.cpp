@@ -0,0 +1,159 @@
+#include "Targeting.h"
+#include <algorithm>
+
+DensityTargeting::DensityTargeting(int size, int maxShipLength) 
+    : size(size), masks(size), allowed(size * size), starts(size * size), 
+      candidates(size * size), table(nullptr), cellBits(1) {
+    for (auto& counter : counters) {
+        counter = Bitboard(size * size);
+    }
+    masks.ensureLength(maxShipLength);
+    while ((1LL << cellBits) < static_cast<long long>(size) * size) cellBits++;
+}
+
+void DensityTargeting::clearCounters() {
+    for (auto& counter : counters) {
+        counter.clear();
+    }
+}
+
+void DensityTargeting::addCoverage(const Bitboard& placementStarts, int length, bool vertical, int weight) {
+    int stride = masks.step(vertical);
+    int words = placementStarts.getWordCount();
+    weight = std::min(weight, COUNTER_MAX);
+    
+    // каждое положение накрывает клетки start, start + stride, ...
+    // сдвинутая маска начал прибавляется к счётчикам сумматором с переносом
+    for (int k = 0; k < length; k++) {
+        for (int i = 0; i < words; i++) {
+            uint64_t cover = placementStarts.getWordShiftedUp(i, k * stride);
+            if (!cover) continue;
+            
+            for (int bit = 0; bit < COUNTER_BITS && (weight >> bit); bit++) {
+                if (!((weight >> bit) & 1)) continue;
+                uint64_t carry = cover;
+                for (int plane = bit; plane < COUNTER_BITS && carry; plane++) {
+                    uint64_t word = counters[plane].getWord(i);
+                    counters[plane].setWord(i, word ^ carry);
+                    carry &= word;
+                }
+                // перенос из старшего среза: у этих клеток счётчик перевалил за COUNTER_MAX
+                for (int plane = 0; plane < COUNTER_BITS && carry; plane++) {
+                    counters[plane].setWord(i, counters[plane].getWord(i) | carry);
+                }
+            }
+        }
+    }
+}
+
+bool DensityTargeting::accumulate(const Observation& observation, bool requireHit) {
+    const std::vector<int>& remaining = observation.getRemainingShips();
+    const Bitboard& hits = observation.getHits();
+    bool any = false;
+    
+    clearCounters();
+    
+    // каждая длина учитывается один раз с весом - числом таких кораблей
+    int maxLength = 0;
+    for (int length : remaining) maxLength = std::max(maxLength, length);
+    masks.ensureLength(maxLength);
+    
+    for (int length = 1; length <= maxLength; length++) {
+        int weight = static_cast<int>(std::count(remaining.begin(), remaining.end(), length));
+        if (weight == 0) continue;
+        
+        for (int orientation = 0; orientation < 2; orientation++) {
+            bool vertical = orientation == 1;
+            masks.legalStarts(allowed, length, vertical, starts);
+            
+            if (requireHit) {
+                // оставляем только положения, накрывающие хотя бы одно попадание
+                int stride = masks.step(vertical);
+                for (int i = 0; i < starts.getWordCount(); i++) {
+                    uint64_t word = 0;
+                    for (int k = 0; k < length; k++) {
+                        word |= hits.getWordShiftedDown(i, k * stride);
+                    }
+                    starts.setWord(i, starts.getWord(i) & word);
+                }
+            }
+            
+            if (starts.any()) {
+                any = true;
+                addCoverage(starts, length, vertical, weight);
+            }
+        }
+    }
+    return any;
+}
+
+int DensityTargeting::chooseTarget(const Observation& observation, Rng& rng) {
+    const Bitboard& full = masks.getFullBoard();
+    
+    // корабль может стоять на неизвестных клетках и на попаданиях
+    allowed = full;
+    allowed.andNot(observation.getMisses());
+    allowed.andNot(observation.getSunk());
+    
+    candidates = allowed;
+    candidates.andNot(observation.getHits());
+    if (!candidates.any()) return -1;
+    
+    // в таблице - клетки с наибольшей плотностью (см. TIE_COUNT_BITS); жребий между ними
+    // тянется из rng и при попадании в таблицу, поэтому партия с зерном от таблицы не зависит
+    uint64_t key = observation.getHash();
+    uint64_t cached;
+    if (table && table->probe(key, cached)) {
+        int count = static_cast<int>(cached & TIE_COUNT_MASK);
+        uint64_t cellMask = (1ULL << cellBits) - 1;
+        // при коллизии хешей клетки могут оказаться уже обстрелянными - тогда считаем заново
+        bool valid = count > 0 && count * cellBits <= 64 - TIE_COUNT_BITS;
+        for (int i = 0; valid && i < count; i++) {
+            int cell = static_cast<int>((cached >> (TIE_COUNT_BITS + i * cellBits)) & cellMask);
+            valid = cell < size * size && candidates.test(cell);
+        }
+        if (valid) {
+            int choice = rng.below(count);
+            return static_cast<int>((cached >> (TIE_COUNT_BITS + choice * cellBits)) & cellMask);
+        }
+    }
+    
+    // пока есть недобитый корабль, считаем только положения через попадания
+    bool targetMode = observation.getHits().any();
+    if (!(targetMode && accumulate(observation, true))) {
+        accumulate(observation, false);
+    }
+    
+    // максимум по срезам: от старшего бита к младшему сужаем множество кандидатов
+    for (int plane = COUNTER_BITS - 1; plane >= 0; plane--) {
+        Bitboard narrowed = candidates;
+        narrowed &= counters[plane];
+        if (narrowed.any()) {
+            candidates = narrowed;
+        }
+    }
+    
+    int count = candidates.count();
+    int choice = rng.below(count);
+    int cell = candidates.select(choice);
+    
+    // ничья из большего числа клеток, чем помещается в запись, не кэшируется
+    if (table && count * cellBits <= 64 - TIE_COUNT_BITS && count <= static_cast<int>(TIE_COUNT_MASK)) {
+        uint64_t entry = static_cast<uint64_t>(count);
+        int i = 0;
+        candidates.forEachSetBit([&](int tied) {
+            entry |= static_cast<uint64_t>(tied) << (TIE_COUNT_BITS + i++ * cellBits);
+        });
+        table->store(key, entry);
+    }
+    return cell;
+}
+
+int DensityTargeting::getDensity(int x, int y) const {
+    int index = y * size + x;
+    int value = 0;
+    for (int plane = 0; plane < COUNTER_BITS; plane++) {
+        if (counters[plane].test(index)) value |= 1 << plane;
+    }
+    return value;
+}
@@ -0,0 +1,60 @@
+#ifndef TARGETING_H
+#define TARGETING_H
+
+#include "Observation.h"
+#include "PlacementMasks.h"
+#include "Random.h"
+#include "TranspositionTable.h"
+
+// стратегии выбора цели компьютером
+enum class TargetingStrategy {
+    HuntTarget,  // случайный выстрел, после попадания - соседние клетки
+    Density      // клетка, накрытая наибольшим числом допустимых положений кораблей
+};
+
+// выбор цели по плотности вероятности
+// для каждой неизвестной клетки считается, сколько допустимых положений 
+// оставшихся кораблей её накрывают; счётчики хранятся поразрядно 
+// (битовые срезы), так что одна операция над словом складывает 64 клетки;
+// счётчик насыщается на COUNTER_MAX, а не переполняется
+class DensityTargeting {
+private:
+    static const int COUNTER_BITS = 16;
+    static const int COUNTER_MAX = (1 << COUNTER_BITS) - 1;
+    // запись таблицы: младшие биты - число клеток ничьей, выше - сами клетки
+    // по cellBits бит в порядке возрастания
+    static const int TIE_COUNT_BITS = 4;
+    static const uint64_t TIE_COUNT_MASK = (1ULL << TIE_COUNT_BITS) - 1;
+    
+    int size;
+    PlacementMasks masks;
+    Bitboard counters[COUNTER_BITS];  // срез k - k-й бит счётчика каждой клетки
+    Bitboard allowed;
+    Bitboard starts;
+    Bitboard candidates;
+    TranspositionTable* table;  // общий кэш клеток с наибольшей плотностью по хешу наблюдения, может быть nullptr
+    int cellBits;               // бит на номер клетки в записи таблицы
+    
+    void clearCounters();
+    void addCoverage(const Bitboard& placementStarts, int length, bool vertical, int weight);
+    bool accumulate(const Observation& observation, bool requireHit);
+    
+public:
+    // маски положений кораблей до maxShipLength готовятся сразу, чтобы ходы не выделяли память
+    explicit DensityTargeting(int size, int maxShipLength = 0);
+    
+    int getSize() const { return size; }
+    
+    // одно и то же наблюдение встречается во множестве партий: клетки с наибольшей
+    // плотностью запоминаются по хешу и при повторе берутся из таблицы без подсчёта;
+    // жребий между ними всегда из rng, так что таблица не меняет ходов
+    void setTranspositionTable(TranspositionTable* transpositionTable) { table = transpositionTable; }
+    
+    // индекс клетки (y * size + x) для следующего выстрела, -1 - стрелять некуда
+    int chooseTarget(const Observation& observation, Rng& rng);
+    
+    // число положений, накрывающих клетку, после последнего подсчёта (не из таблицы)
+    int getDensity(int x, int y) const;
+};
+
+#endif
@@ -0,0 +1,102 @@
+#include "ThreadPool.h"
+
+WorkStealingPool::WorkStealingPool(int threadCount) 
+    : generation(0), activeWorkers(0), stopping(false) {
+    if (threadCount <= 0) {
+        threadCount = defaultThreadCount();
+    }
+    
+    for (int i = 0; i < threadCount; i++) {
+        queues.push_back(std::make_unique<WorkerQueue>());
+    }
+    for (int i = 0; i < threadCount; i++) {
+        threads.emplace_back(&WorkStealingPool::workerLoop, this, i);
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        stopping = true;
+    }
+    wakeCondition.notify_all();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+int WorkStealingPool::defaultThreadCount() {
+    unsigned cores = std::thread::hardware_concurrency();
+    return cores > 0 ? static_cast<int>(cores) : 1;
+}
+
+bool WorkStealingPool::popLocal(int worker, int& task) {
+    WorkerQueue& queue = *queues[worker];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty()) return false;
+    task = queue.tasks.front();
+    queue.tasks.pop_front();
+    return true;
+}
+
+bool WorkStealingPool::steal(int worker, int& task) {
+    int count = static_cast<int>(queues.size());
+    for (int i = 1; i < count; i++) {
+        WorkerQueue& victim = *queues[(worker + i) % count];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = victim.tasks.back();
+            victim.tasks.pop_back();
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkStealingPool::workerLoop(int worker) {
+    int seenGeneration = 0;
+    
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(stateMutex);
+            wakeCondition.wait(lock, [&] { return stopping || generation != seenGeneration; });
+            if (stopping) return;
+            seenGeneration = generation;
+        }
+        
+        int task;
+        while (popLocal(worker, task) || steal(worker, task)) {
+            job(task, worker);
+        }
+        
+        {
+            std::lock_guard<std::mutex> lock(stateMutex);
+            activeWorkers--;
+        }
+        doneCondition.notify_all();
+    }
+}
+
+void WorkStealingPool::run(int taskCount, std::function<void(int, int)> taskJob) {
+    int count = static_cast<int>(queues.size());
+    
+    // раздаём задачи непрерывными блоками, остальное выравнивается перехватом
+    for (int worker = 0; worker < count; worker++) {
+        int begin = static_cast<int>(static_cast<long long>(taskCount) * worker / count);
+        int end = static_cast<int>(static_cast<long long>(taskCount) * (worker + 1) / count);
+        std::lock_guard<std::mutex> lock(queues[worker]->mutex);
+        for (int task = begin; task < end; task++) {
+            queues[worker]->tasks.push_back(task);
+        }
+    }
+    
+    {
+        std::unique_lock<std::mutex> lock(stateMutex);
+        job = std::move(taskJob);
+        activeWorkers = count;
+        generation++;
+        wakeCondition.notify_all();
+        doneCondition.wait(lock, [&] { return activeWorkers == 0; });
+        job = nullptr;
+    }
+}
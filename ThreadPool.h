@@ -0,0 +1,54 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <vector>
+#include <memory>
+#include <functional>
+
+// пул потоков с перехватом задач (work stealing)
+// каждый поток берёт задачи из начала своей очереди, а опустев - 
+// забирает задачи с конца очередей соседей
+class WorkStealingPool {
+private:
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::deque<int> tasks;
+    };
+    
+    std::vector<std::thread> threads;
+    std::vector<std::unique_ptr<WorkerQueue>> queues;
+    std::function<void(int, int)> job;
+    
+    std::mutex stateMutex;
+    std::condition_variable wakeCondition;
+    std::condition_variable doneCondition;
+    int generation;
+    int activeWorkers;
+    bool stopping;
+    
+    bool popLocal(int worker, int& task);
+    bool steal(int worker, int& task);
+    void workerLoop(int worker);
+    
+public:
+    // threadCount = 0 - по числу ядер машины
+    explicit WorkStealingPool(int threadCount = 0);
+    ~WorkStealingPool();
+    
+    // запрет копирования
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+    
+    int getThreadCount() const { return static_cast<int>(threads.size()); }
+    
+    // выполнить задачи 0..taskCount-1, job(задача, номер потока); возврат после завершения всех
+    void run(int taskCount, std::function<void(int, int)> taskJob);
+    
+    static int defaultThreadCount();
+};
+
+#endif
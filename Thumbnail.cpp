@@ -0,0 +1,323 @@
+#include "Thumbnail.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+
+// те же цвета, что у FieldRenderer
+const uint8_t Thumbnail::PALETTE[COLOR_COUNT][3] = {
+    {255, 255, 255},  // Background
+    {230, 240, 255},  // Water
+    {100, 100, 100},  // ShipDeck
+    {255, 200, 200},  // HitCell
+    {255, 150, 150},  // DestroyedCell
+    {255, 0, 0},      // HitMark
+    {0, 0, 0},        // MissMark
+    {150, 150, 200}   // BlockedMark
+};
+
+namespace {
+    // таблица CRC-32 для кусков PNG
+    struct CrcTable {
+        uint32_t values[256];
+        
+        CrcTable() {
+            for (uint32_t n = 0; n < 256; n++) {
+                uint32_t c = n;
+                for (int k = 0; k < 8; k++) {
+                    c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+                }
+                values[n] = c;
+            }
+        }
+    };
+    
+    const CrcTable CRC_TABLE;
+    
+    uint32_t crc32(const uint8_t* data, size_t length) {
+        uint32_t c = 0xFFFFFFFFu;
+        for (size_t i = 0; i < length; i++) {
+            c = CRC_TABLE.values[(c ^ data[i]) & 0xFF] ^ (c >> 8);
+        }
+        return c ^ 0xFFFFFFFFu;
+    }
+    
+    void putUint32Be(std::vector<uint8_t>& out, uint32_t value) {
+        out.push_back(static_cast<uint8_t>(value >> 24));
+        out.push_back(static_cast<uint8_t>(value >> 16));
+        out.push_back(static_cast<uint8_t>(value >> 8));
+        out.push_back(static_cast<uint8_t>(value));
+    }
+    
+    // начало куска: место под длину и тип; возвращает смещение длины
+    size_t beginChunk(std::vector<uint8_t>& out, const char* type) {
+        size_t start = out.size();
+        putUint32Be(out, 0);
+        out.insert(out.end(), type, type + 4);
+        return start;
+    }
+    
+    // длина и CRC куска (CRC считается по типу и данным)
+    void endChunk(std::vector<uint8_t>& out, size_t start) {
+        uint32_t length = static_cast<uint32_t>(out.size() - start - 8);
+        out[start] = static_cast<uint8_t>(length >> 24);
+        out[start + 1] = static_cast<uint8_t>(length >> 16);
+        out[start + 2] = static_cast<uint8_t>(length >> 8);
+        out[start + 3] = static_cast<uint8_t>(length);
+        putUint32Be(out, crc32(out.data() + start + 4, out.size() - start - 4));
+    }
+}
+
+Thumbnail::Thumbnail() : width(0), height(0) {}
+
+void Thumbnail::resize(int imageWidth, int imageHeight) {
+    width = imageWidth;
+    height = imageHeight;
+    pixels.assign(static_cast<size_t>(width) * height, Background);
+}
+
+void Thumbnail::fillRect(int left, int top, int rectWidth, int rectHeight, uint8_t color) {
+    int x0 = std::max(left, 0);
+    int y0 = std::max(top, 0);
+    int x1 = std::min(left + rectWidth, width);
+    int y1 = std::min(top + rectHeight, height);
+    for (int y = y0; y < y1; y++) {
+        std::fill(pixels.begin() + static_cast<size_t>(y) * width + x0,
+                  pixels.begin() + static_cast<size_t>(y) * width + x1, color);
+    }
+}
+
+void Thumbnail::drawField(const Field& field, int left, int top, int cellPixels, bool hideShips) {
+    // от 3 пикселей на клетку между клетками остаётся линия фона, как в окне
+    int tile = cellPixels >= 3 ? cellPixels - 1 : cellPixels;
+    int inset = cellPixels / 7;
+    int size = field.getSize();
+    
+    for (int y = 0; y < size; y++) {
+        for (int x = 0; x < size; x++) {
+            CellState state = field.getCellState(x, y);
+            int cellLeft = left + x * cellPixels;
+            int cellTop = top + y * cellPixels;
+            
+            uint8_t color = Water;
+            if (state == CellState::Ship && !hideShips) color = ShipDeck;
+            else if (state == CellState::Hit) color = HitCell;
+            else if (state == CellState::Destroyed) color = DestroyedCell;
+            
+            // на мелких клетках отметка не помещается: промах закрашивает клетку целиком
+            if (tile < 3) {
+                fillRect(cellLeft, cellTop, tile, tile, state == CellState::Miss ? MissMark : color);
+                continue;
+            }
+            fillRect(cellLeft, cellTop, tile, tile, color);
+            
+            switch (state) {
+                case CellState::Hit:
+                case CellState::Destroyed:
+                    // крестик по диагоналям
+                    for (int i = inset; i < tile - inset; i++) {
+                        pixels[static_cast<size_t>(cellTop + i) * width + cellLeft + i] = HitMark;
+                        pixels[static_cast<size_t>(cellTop + i) * width + cellLeft + tile - 1 - i] = HitMark;
+                    }
+                    break;
+                case CellState::Miss: {
+                    int dot = std::max(1, std::min(8, cellPixels / 4));
+                    fillRect(cellLeft + (tile - dot) / 2, cellTop + (tile - dot) / 2, dot, dot, MissMark);
+                    break;
+                }
+                case CellState::Blocked:
+                    if (!hideShips) {
+                        int dot = std::max(1, std::min(4, cellPixels / 8));
+                        fillRect(cellLeft + (tile - dot) / 2, cellTop + (tile - dot) / 2, dot, dot, BlockedMark);
+                    }
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+}
+
+void Thumbnail::render(const Field& field, int cellPixels, bool hideShips) {
+    int side = field.getSize() * cellPixels;
+    resize(side, side);
+    drawField(field, 0, 0, cellPixels, hideShips);
+}
+
+void Thumbnail::renderPair(const Field& first, const Field& second, int cellPixels) {
+    int firstSide = first.getSize() * cellPixels;
+    int secondSide = second.getSize() * cellPixels;
+    resize(firstSide + PAIR_GAP + secondSide, std::max(firstSide, secondSide));
+    drawField(first, 0, 0, cellPixels, false);
+    drawField(second, firstSide + PAIR_GAP, 0, cellPixels, false);
+}
+
+const std::vector<uint8_t>& Thumbnail::encodePng() {
+    encoded.clear();
+    const uint8_t signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    encoded.insert(encoded.end(), signature, signature + 8);
+    
+    // IHDR: 8 бит на пиксель, палитра
+    size_t chunk = beginChunk(encoded, "IHDR");
+    putUint32Be(encoded, static_cast<uint32_t>(width));
+    putUint32Be(encoded, static_cast<uint32_t>(height));
+    const uint8_t header[5] = {8, 3, 0, 0, 0};
+    encoded.insert(encoded.end(), header, header + 5);
+    endChunk(encoded, chunk);
+    
+    chunk = beginChunk(encoded, "PLTE");
+    for (int i = 0; i < COLOR_COUNT; i++) {
+        encoded.insert(encoded.end(), PALETTE[i], PALETTE[i] + 3);
+    }
+    endChunk(encoded, chunk);
+    
+    // IDAT: поток zlib из несжатых блоков deflate по 65535 байт;
+    // строка изображения - байт фильтра (0) и индексы палитры
+    chunk = beginChunk(encoded, "IDAT");
+    encoded.push_back(0x78);
+    encoded.push_back(0x01);
+    size_t rawSize = static_cast<size_t>(width + 1) * height;
+    size_t row = 0, column = 0;  // позиция в несжатых данных: строка и байт в строке
+    uint32_t adlerA = 1, adlerB = 0;
+    size_t remaining = rawSize;
+    do {
+        uint16_t blockSize = static_cast<uint16_t>(std::min<size_t>(remaining, 65535));
+        remaining -= blockSize;
+        encoded.push_back(remaining == 0 ? 1 : 0);
+        encoded.push_back(static_cast<uint8_t>(blockSize));
+        encoded.push_back(static_cast<uint8_t>(blockSize >> 8));
+        encoded.push_back(static_cast<uint8_t>(~blockSize));
+        encoded.push_back(static_cast<uint8_t>(~blockSize >> 8));
+        
+        size_t left = blockSize;
+        while (left > 0) {
+            const uint8_t* source;
+            size_t count;
+            const uint8_t filter = 0;
+            if (column == 0) {
+                source = &filter;
+                count = 1;
+            } else {
+                source = pixels.data() + row * width + (column - 1);
+                // не больше 5552 байт между взятиями по модулю, иначе сумма B переполнится
+                count = std::min({left, static_cast<size_t>(width) + 1 - column, static_cast<size_t>(5552)});
+            }
+            encoded.insert(encoded.end(), source, source + count);
+            for (size_t i = 0; i < count; i++) {
+                adlerA += source[i];
+                adlerB += adlerA;
+            }
+            adlerA %= 65521;
+            adlerB %= 65521;
+            left -= count;
+            column += count;
+            if (column == static_cast<size_t>(width) + 1) {
+                column = 0;
+                row++;
+            }
+        }
+    } while (remaining > 0);
+    putUint32Be(encoded, (adlerB << 16) | adlerA);
+    endChunk(encoded, chunk);
+    
+    chunk = beginChunk(encoded, "IEND");
+    endChunk(encoded, chunk);
+    return encoded;
+}
+
+bool Thumbnail::writePng(const std::string& path) {
+    const std::vector<uint8_t>& png = encodePng();
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char*>(png.data()), png.size());
+    return out.good();
+}
+
+bool Thumbnail::writePpm(const std::string& path) const {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out << "P6\n" << width << " " << height << "\n255\n";
+    std::vector<uint8_t> rgb(static_cast<size_t>(width) * 3);
+    for (int y = 0; y < height; y++) {
+        const uint8_t* line = pixels.data() + static_cast<size_t>(y) * width;
+        for (int x = 0; x < width; x++) {
+            std::copy(PALETTE[line[x]], PALETTE[line[x]] + 3, rgb.begin() + 3 * x);
+        }
+        out.write(reinterpret_cast<const char*>(rgb.data()), rgb.size());
+    }
+    return out.good();
+}
+
+// ThumbnailBatch
+
+ThumbnailBatch::ThumbnailBatch(int threadCount)
+    : pool(threadCount), workers(pool.getThreadCount()) {}
+
+bool ThumbnailBatch::render(const std::string& recordPath, const Options& options, Stats& stats) {
+    stats = Stats();
+    GameRecordReader reader;
+    if (!reader.open(recordPath)) return false;
+    
+    std::error_code error;
+    std::filesystem::create_directories(options.outputDirectory, error);
+    if (error) return false;
+    
+    const BoardConfig& config = reader.getConfig();
+    for (WorkerState& worker : workers) {
+        worker.first = std::make_unique<Field>(config);
+        worker.second = std::make_unique<Field>(config);
+        worker.stats = Stats();
+    }
+    
+    const char* extension = options.format == Format::Png ? "png" : "ppm";
+    std::vector<GameRecord> batch(BATCH_RECORDS);
+    long long firstIndex = 0;
+    auto start = std::chrono::steady_clock::now();
+    
+    while (options.limit < 0 || firstIndex < options.limit) {
+        // пачка читается одним потоком: разбор записи дешевле её отрисовки
+        int count = 0;
+        while (count < BATCH_RECORDS && (options.limit < 0 || firstIndex + count < options.limit) &&
+               reader.next(batch[count])) {
+            count++;
+        }
+        if (count == 0) break;
+        
+        int tasks = (count + RECORDS_PER_TASK - 1) / RECORDS_PER_TASK;
+        pool.run(tasks, [&](int task, int workerIndex) {
+            WorkerState& worker = workers[workerIndex];
+            int end = std::min(count, (task + 1) * RECORDS_PER_TASK);
+            for (int i = task * RECORDS_PER_TASK; i < end; i++) {
+                if (!batch[i].replay(*worker.first, *worker.second, options.position)) {
+                    worker.stats.failed++;
+                    continue;
+                }
+                worker.image.renderPair(*worker.first, *worker.second, options.cellPixels);
+                
+                char name[32];
+                std::snprintf(name, sizeof(name), "game_%06lld.%s", firstIndex + i, extension);
+                std::string path = (std::filesystem::path(options.outputDirectory) / name).string();
+                bool written;
+                if (options.format == Format::Png) {
+                    written = worker.image.writePng(path);
+                    worker.stats.bytes += static_cast<long long>(worker.image.getEncodedSize());
+                } else {
+                    written = worker.image.writePpm(path);
+                    worker.stats.bytes += 3LL * worker.image.getWidth() * worker.image.getHeight();
+                }
+                if (written) worker.stats.images++;
+                else worker.stats.failed++;
+            }
+        });
+        firstIndex += count;
+    }
+    // оборванный или испорченный хвост файла - тоже испорченная запись
+    if (reader.failed()) stats.failed++;
+    
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    for (const WorkerState& worker : workers) {
+        stats.images += worker.stats.images;
+        stats.failed += worker.stats.failed;
+        stats.bytes += worker.stats.bytes;
+    }
+    return true;
+}
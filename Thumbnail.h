@@ -0,0 +1,114 @@
+#ifndef THUMBNAIL_H
+#define THUMBNAIL_H
+
+#include "Field.h"
+#include "GameRecord.h"
+#include "ThreadPool.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <memory>
+
+// миниатюра поля без окна и видеокарты: клетки закрашиваются прямо в буфер
+// индексов палитры, поэтому рисовать можно из любого числа потоков без контекста OpenGL;
+// цвета те же, что у FieldRenderer
+class Thumbnail {
+public:
+    enum Color : uint8_t {
+        Background,  // промежутки между клетками и полями
+        Water,
+        ShipDeck,
+        HitCell,
+        DestroyedCell,
+        HitMark,     // крестик попадания
+        MissMark,    // точка промаха
+        BlockedMark, // точка вокруг корабля
+        COLOR_COUNT
+    };
+    
+    static const uint8_t PALETTE[COLOR_COUNT][3];
+
+private:
+    int width, height;
+    std::vector<uint8_t> pixels;   // индексы палитры по строкам
+    std::vector<uint8_t> encoded;  // буфер PNG, переиспользуется между кадрами
+    
+    void resize(int imageWidth, int imageHeight);
+    void fillRect(int left, int top, int rectWidth, int rectHeight, uint8_t color);
+    void drawField(const Field& field, int left, int top, int cellPixels, bool hideShips);
+
+public:
+    // промежуток между полями в паре, в пикселях
+    static const int PAIR_GAP = 4;
+    
+    Thumbnail();
+    
+    // одно поле, cellPixels пикселей на клетку (с промежутком в 1 пиксель от 3 и больше)
+    void render(const Field& field, int cellPixels, bool hideShips = false);
+    
+    // позиция партии целиком: поля первого и второго игрока рядом, корабли видны
+    void renderPair(const Field& first, const Field& second, int cellPixels);
+    
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+    const std::vector<uint8_t>& getPixels() const { return pixels; }
+    
+    // PNG с палитрой; сжатие не используется (блоки deflate без кодирования),
+    // так что кодирование - копирование строк и подсчёт CRC
+    const std::vector<uint8_t>& encodePng();
+    bool writePng(const std::string& path);
+    size_t getEncodedSize() const { return encoded.size(); }
+    
+    // PPM (P6) - сырые RGB-пиксели
+    bool writePpm(const std::string& path) const;
+};
+
+// миниатюры для архива записанных партий на всех ядрах
+// записи читаются последовательно пачками, а рисуются и пишутся в файлы параллельно
+class ThumbnailBatch {
+public:
+    enum class Format { Png, Ppm };
+    
+    struct Options {
+        std::string outputDirectory;
+        int cellPixels = 6;
+        int position = -1;        // позиция после стольких выстрелов, -1 - конец партии
+        long long limit = -1;     // сколько партий взять из файла, -1 - все
+        Format format = Format::Png;
+    };
+    
+    struct Stats {
+        long long images = 0;
+        long long failed = 0;     // испорченные записи и ошибки записи файлов
+        long long bytes = 0;
+        double seconds = 0.0;
+    };
+
+private:
+    // партий в пачке чтения и в одной задаче пула
+    static const int BATCH_RECORDS = 4096;
+    static const int RECORDS_PER_TASK = 64;
+    
+    // поля и изображение потока, выровненные по строке кэша
+    struct alignas(64) WorkerState {
+        std::unique_ptr<Field> first;
+        std::unique_ptr<Field> second;
+        Thumbnail image;
+        Stats stats;
+    };
+    
+    WorkStealingPool pool;
+    std::vector<WorkerState> workers;
+
+public:
+    // threadCount = 0 - по числу ядер машины
+    explicit ThumbnailBatch(int threadCount = 0);
+    
+    int getThreadCount() const { return pool.getThreadCount(); }
+    
+    // миниатюры всех партий файла в options.outputDirectory (game_000000.png, ...);
+    // false - файл партий не открылся или каталог не создать, испорченные партии считаются в stats.failed
+    bool render(const std::string& recordPath, const Options& options, Stats& stats);
+};
+
+#endif
@@ -0,0 +1,78 @@
+#include "Tournament.h"
+#include "Random.h"
+#include <chrono>
+#include <iomanip>
+
+Tournament::Tournament(int threadCount, TargetingStrategy player1Strategy, 
+                       TargetingStrategy player2Strategy, const BoardConfig& config) 
+    : pool(threadCount), workers(pool.getThreadCount()), 
+      player1Strategy(player1Strategy), player2Strategy(player2Strategy), config(config), 
+      transpositionTable(nullptr) {
+    for (auto& worker : workers) {
+        worker.simulator = std::make_unique<HeadlessSimulator>(player1Strategy, player2Strategy, config);
+    }
+}
+
+void Tournament::setTranspositionTable(TranspositionTable* table) {
+    transpositionTable = table;
+    for (auto& worker : workers) {
+        worker.simulator->setTranspositionTable(table);
+    }
+}
+
+SimulationStats Tournament::play(long long games, uint64_t seed) {
+    for (auto& worker : workers) {
+        worker.stats = SimulationStats();
+    }
+    
+    long long taskCount = (games + GAMES_PER_TASK - 1) / GAMES_PER_TASK;
+    
+    auto start = std::chrono::steady_clock::now();
+    pool.run(static_cast<int>(taskCount), [&](int task, int worker) {
+        WorkerState& state = workers[worker];
+        threadRng() = Rng::forStream(seed, task);
+        
+        long long first = static_cast<long long>(task) * GAMES_PER_TASK;
+        long long count = std::min<long long>(GAMES_PER_TASK, games - first);
+        state.stats.merge(state.simulator->run(count));
+    });
+    auto finish = std::chrono::steady_clock::now();
+    
+    SimulationStats total;
+    for (const auto& worker : workers) {
+        total.merge(worker.stats);
+    }
+    total.seconds = std::chrono::duration<double>(finish - start).count();
+    return total;
+}
+
+void Tournament::printScalingReport(std::ostream& os, long long games, uint64_t seed) const {
+    int maxThreads = WorkStealingPool::defaultThreadCount();
+    
+    std::vector<int> threadCounts;
+    for (int threads = 1; threads < maxThreads; threads *= 2) {
+        threadCounts.push_back(threads);
+    }
+    threadCounts.push_back(maxThreads);
+    
+    os << "Масштабирование (" << games << " партий на прогон)\n";
+    os << "Потоков   Партий/с      Ускорение  Эффективность\n";
+    
+    double baseRate = 0.0;
+    for (int threads : threadCounts) {
+        Tournament tournament(threads, player1Strategy, player2Strategy, config);
+        // каждый прогон начинается с пустой таблицей, иначе следующие получат чужой прогретый кэш
+        if (transpositionTable) transpositionTable->clear();
+        tournament.setTranspositionTable(transpositionTable);
+        SimulationStats stats = tournament.play(games, seed);
+        
+        double rate = stats.gamesPerSecond();
+        if (baseRate == 0.0) baseRate = rate;
+        double speedup = baseRate > 0.0 ? rate / baseRate : 0.0;
+        
+        os << std::setw(7) << threads << "   "
+           << std::fixed << std::setprecision(1) << std::setw(12) << rate << "  "
+           << std::setprecision(2) << std::setw(9) << speedup << "  "
+           << std::setprecision(1) << std::setw(12) << speedup / threads * 100.0 << "%\n";
+    }
+}
@@ -0,0 +1,51 @@
+#ifndef TOURNAMENT_H
+#define TOURNAMENT_H
+
+#include "Simulation.h"
+#include "ThreadPool.h"
+#include <iostream>
+#include <vector>
+#include <memory>
+
+// турнир компьютер против компьютера на всех ядрах машины
+// у каждого потока своя партия и свои счётчики, которые объединяются после завершения;
+// у каждой задачи свой поток случайных чисел от общего зерна, поэтому итог
+// не зависит ни от числа потоков, ни от того, какой поток украл какую задачу
+class Tournament {
+private:
+    // партий в одной задаче пула
+    static const int GAMES_PER_TASK = 256;
+    
+    // данные потока, выровненные по строке кэша
+    struct alignas(64) WorkerState {
+        std::unique_ptr<HeadlessSimulator> simulator;
+        SimulationStats stats;
+    };
+    
+    WorkStealingPool pool;
+    std::vector<WorkerState> workers;
+    TargetingStrategy player1Strategy;
+    TargetingStrategy player2Strategy;
+    BoardConfig config;
+    TranspositionTable* transpositionTable;
+    
+public:
+    // threadCount = 0 - по числу ядер машины
+    explicit Tournament(int threadCount = 0, 
+                        TargetingStrategy player1Strategy = TargetingStrategy::HuntTarget,
+                        TargetingStrategy player2Strategy = TargetingStrategy::HuntTarget,
+                        const BoardConfig& config = BoardConfig());
+    
+    int getThreadCount() const { return pool.getThreadCount(); }
+    
+    // одна таблица на все потоки: записи без блокировок, найденное одним потоком видят остальные
+    void setTranspositionTable(TranspositionTable* table);
+    
+    // сыграть games партий, seed задаёт зёрна всех партий
+    SimulationStats play(long long games, uint64_t seed);
+    
+    // прогон на 1, 2, 4, ... ядрах с выводом ускорения
+    void printScalingReport(std::ostream& os, long long games, uint64_t seed) const;
+};
+
+#endif
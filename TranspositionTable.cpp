@@ -0,0 +1,19 @@
+#include "TranspositionTable.h"
+
+TranspositionTable::TranspositionTable(size_t megabytes) {
+    size_t count = 1;
+    size_t limit = megabytes * 1024 * 1024 / sizeof(Entry);
+    while (count * 2 <= limit) count *= 2;
+    
+    entries.reset(new Entry[count]);
+    mask = count - 1;
+    clear();
+}
+
+void TranspositionTable::clear() {
+    // нулевой ключ не встречается: хеши начинаются с boardKey
+    for (size_t i = 0; i <= mask; i++) {
+        entries[i].check.store(0, std::memory_order_relaxed);
+        entries[i].value.store(0, std::memory_order_relaxed);
+    }
+}
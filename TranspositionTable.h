@@ -0,0 +1,53 @@
+#ifndef TRANSPOSITION_TABLE_H
+#define TRANSPOSITION_TABLE_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+
+// таблица транспозиций фиксированного размера без блокировок:
+// по 64-битному хешу состояния хранит 64-битный результат (ход, оценку и т.п.)
+// запись - пара слов (key ^ value, value); при одновременной записи из разных потоков
+// разорванная запись не проходит проверку и просто считается отсутствующей
+// при коллизии индекса старая запись заменяется новой
+class TranspositionTable {
+private:
+    struct Entry {
+        std::atomic<uint64_t> check;  // key ^ value
+        std::atomic<uint64_t> value;
+    };
+    
+    std::unique_ptr<Entry[]> entries;
+    size_t mask;  // число записей - степень двойки
+    
+public:
+    // память под таблицу в мегабайтах, округляется вниз до степени двойки записей
+    explicit TranspositionTable(size_t megabytes);
+    
+    TranspositionTable(const TranspositionTable&) = delete;
+    TranspositionTable& operator=(const TranspositionTable&) = delete;
+    
+    bool probe(uint64_t key, uint64_t& value) const;
+    void store(uint64_t key, uint64_t value);
+    void clear();
+    
+    size_t getEntryCount() const { return mask + 1; }
+};
+
+inline bool TranspositionTable::probe(uint64_t key, uint64_t& value) const {
+    const Entry& entry = entries[key & mask];
+    uint64_t stored = entry.value.load(std::memory_order_relaxed);
+    uint64_t check = entry.check.load(std::memory_order_relaxed);
+    if ((check ^ stored) != key) return false;
+    value = stored;
+    return true;
+}
+
+inline void TranspositionTable::store(uint64_t key, uint64_t value) {
+    Entry& entry = entries[key & mask];
+    entry.value.store(value, std::memory_order_relaxed);
+    entry.check.store(key ^ value, std::memory_order_relaxed);
+}
+
+#endif
@@ -0,0 +1,11 @@
+#include "Zobrist.h"
+
+uint64_t Zobrist::boardKey(int size, const std::vector<int>& fleet) {
+    // флот учитывается как мультимножество длин: сумма перемешанных длин не зависит 
+    // от порядка и не требует сортированной копии (сброс наблюдения не выделяет память)
+    uint64_t ships = 0;
+    for (int length : fleet) {
+        ships += mix(static_cast<uint64_t>(length) + 0x3C6EF372FE94F82BULL);
+    }
+    return mix(mix(0x5A0B1C2D3E4F6071ULL ^ static_cast<uint64_t>(size)) ^ ships);
+}
@@ -0,0 +1,36 @@
+#ifndef ZOBRIST_H
+#define ZOBRIST_H
+
+#include <cstdint>
+#include <vector>
+
+// хеширование Зобриста для состояний поля
+// хеш - xor ключей всех (клетка, состояние), поэтому меняется за O(1) на каждую клетку;
+// ключи не хранятся таблицей (поле бывает огромным), а вычисляются перемешиванием номера клетки
+namespace Zobrist {
+    enum Kind {
+        Ship = 0,   // палуба корабля (расстановка)
+        Miss = 1,   // промах или открытая пустая клетка
+        Hit = 2,    // попадание
+        Sunk = 3    // палуба потопленного корабля
+    };
+    
+    // финализатор splitmix64: хорошо перемешивает соседние числа
+    inline uint64_t mix(uint64_t x) {
+        x ^= x >> 30;
+        x *= 0xBF58476D1CE4E5B9ULL;
+        x ^= x >> 27;
+        x *= 0x94D049BB133111EBULL;
+        x ^= x >> 31;
+        return x;
+    }
+    
+    inline uint64_t key(int cell, Kind kind) {
+        return mix(((static_cast<uint64_t>(cell) << 2) | kind) + 0x9E3779B97F4A7C15ULL);
+    }
+    
+    // хеш пустого поля: разные размеры и флоты не совпадают
+    uint64_t boardKey(int size, const std::vector<int>& fleet);
+}
+
+#endif
@@ -0,0 +1,643 @@
+#include "Field.h"
+#include "Player.h"
+#include "Game.h"
+#include "Random.h"
+#include "TranspositionTable.h"
+#include "Tournament.h"
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <map>
+#include <chrono>
+#include <cmath>
+#include <algorithm>
+#include <functional>
+#include <thread>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+// счётчик выделений памяти: глобальный operator new заменён на всю программу
+namespace {
+    std::atomic<long long> allocationCount(0);
+}
+
+void* operator new(std::size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void* memory = std::malloc(size ? size : 1)) return memory;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept {
+    std::free(memory);
+}
+
+// микробенчмарки горячих путей движка
+// каждый замер: прогревочные повторы, затем серия повторов по batch операций,
+// итог - нс на операцию (минимум, медиана, среднее, максимум, разброс)
+namespace {
+    typedef std::chrono::steady_clock Clock;
+
+    // результат операций складывается сюда, чтобы компилятор их не выбросил
+    volatile long long benchSink = 0;
+
+    struct BenchOptions {
+        int warmup = 3;
+        int repetitions = 15;
+        double scale = 1.0;        // множитель числа операций в повторе
+        unsigned seed = 12345;
+        std::string filter;        // подстрока имени замера
+        std::string jsonPath;      // куда записать JSON, "-" - в stdout
+        std::string baselinePath;  // прошлый JSON для сравнения
+        double tolerance = 0.10;   // допустимое замедление медианы
+    };
+
+    struct BenchResult {
+        std::string name;
+        long long operations;  // операций в одном повторе
+        int repetitions;
+        double minNs;
+        double medianNs;
+        double meanNs;
+        double maxNs;
+        double stddevNs;
+    };
+
+    // замер: body(operations) выполняет операции и возвращает затраченные секунды,
+    // чтобы подготовка данных внутри повтора не попадала в замер
+    struct Benchmark {
+        std::string name;
+        long long operations;
+        std::function<double(long long)> body;
+    };
+
+    double secondsSince(Clock::time_point start) {
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    }
+
+    BenchResult runBenchmark(const Benchmark& bench, const BenchOptions& options) {
+        long long operations = std::max<long long>(1, static_cast<long long>(bench.operations * options.scale));
+
+        for (int i = 0; i < options.warmup; i++) {
+            bench.body(operations);
+        }
+
+        std::vector<double> samples;
+        for (int i = 0; i < options.repetitions; i++) {
+            samples.push_back(bench.body(operations) * 1e9 / operations);
+        }
+        std::sort(samples.begin(), samples.end());
+
+        BenchResult result;
+        result.name = bench.name;
+        result.operations = operations;
+        result.repetitions = options.repetitions;
+        result.minNs = samples.front();
+        result.maxNs = samples.back();
+        size_t middle = samples.size() / 2;
+        result.medianNs = samples.size() % 2 ? samples[middle] : (samples[middle - 1] + samples[middle]) / 2;
+
+        double sum = 0.0;
+        for (double sample : samples) sum += sample;
+        result.meanNs = sum / samples.size();
+
+        double variance = 0.0;
+        for (double sample : samples) variance += (sample - result.meanNs) * (sample - result.meanNs);
+        result.stddevNs = samples.size() > 1 ? std::sqrt(variance / (samples.size() - 1)) : 0.0;
+        return result;
+    }
+
+    // поле со случайной стандартной расстановкой
+    Field placedField() {
+        Field field;
+        field.placeAllShipsAuto();
+        return field;
+    }
+
+    // случайный порядок обхода всех клеток поля
+    std::vector<std::pair<int, int>> shuffledCells(int size) {
+        std::vector<std::pair<int, int>> cells;
+        for (int y = 0; y < size; y++) {
+            for (int x = 0; x < size; x++) {
+                cells.push_back({x, y});
+            }
+        }
+        std::shuffle(cells.begin(), cells.end(), threadRng());
+        return cells;
+    }
+
+    // ход по плотности на полностью обстреливаемом поле; table - общий кэш или nullptr
+    double densityMoves(long long operations, TranspositionTable* table) {
+        ComputerPlayer computer("Компьютер", TargetingStrategy::Density, BoardConfig::standard());
+        computer.setTranspositionTable(table);
+        Field target;
+        int cells = target.getSize() * target.getSize();
+        double seconds = 0.0;
+        long long done = 0;
+        while (done < operations) {
+            computer.reset();
+            target.reset();
+            target.placeAllShipsAuto();
+            long long batch = std::min<long long>(cells, operations - done);
+            auto start = Clock::now();
+            for (long long i = 0; i < batch && !target.allShipsDestroyed(); i++) {
+                std::pair<int, int> shot = computer.makeMove();
+                computer.onAttackResult(shot.first, shot.second, target.attack(shot.first, shot.second));
+                done++;
+            }
+            seconds += secondsSince(start);
+        }
+        return seconds;
+    }
+    
+    std::vector<Benchmark> makeBenchmarks() {
+        std::vector<Benchmark> benchmarks;
+
+        // выстрел по полю: поле обстреливается целиком, восстановление не замеряется
+        benchmarks.push_back({"field_attack", 100000, [](long long operations) {
+            Field source = placedField();
+            Field field = source;
+            std::vector<std::pair<int, int>> cells = shuffledCells(field.getSize());
+            double seconds = 0.0;
+            long long done = 0;
+            long long hits = 0;
+            while (done < operations) {
+                field = source;
+                long long batch = std::min<long long>(cells.size(), operations - done);
+                auto start = Clock::now();
+                for (long long i = 0; i < batch; i++) {
+                    hits += field.attack(cells[i].first, cells[i].second) != Field::AttackResult::Miss;
+                }
+                seconds += secondsSince(start);
+                done += batch;
+            }
+            benchSink = benchSink + hits;
+            return seconds;
+        }});
+
+        // проверка всех положений всех кораблей на расставленном поле
+        benchmarks.push_back({"field_can_place_ship", 400000, [](long long operations) {
+            Field field = placedField();
+            int size = field.getSize();
+            long long placeable = 0;
+            long long done = 0;
+            auto start = Clock::now();
+            while (done < operations) {
+                for (int length = 1; length <= 4 && done < operations; length++) {
+                    for (int cell = 0; cell < size * size && done < operations; cell++) {
+                        placeable += field.canPlaceShip(cell % size, cell / size, length, (cell & 1) != 0);
+                        done++;
+                    }
+                }
+            }
+            double seconds = secondsSince(start);
+            benchSink = benchSink + placeable;
+            return seconds;
+        }});
+
+        // автоматическая расстановка всего флота
+        benchmarks.push_back({"field_place_all_ships_auto", 20000, [](long long operations) {
+            Field field;
+            long long ships = 0;
+            auto start = Clock::now();
+            for (long long i = 0; i < operations; i++) {
+                field.placeAllShipsAuto();
+                ships += field.getShipsCount();
+            }
+            double seconds = secondsSince(start);
+            benchSink = benchSink + ships;
+            return seconds;
+        }});
+
+        // копирование расставленного поля
+        benchmarks.push_back({"field_copy", 50000, [](long long operations) {
+            Field source = placedField();
+            long long ships = 0;
+            auto start = Clock::now();
+            for (long long i = 0; i < operations; i++) {
+                Field copy(source);
+                ships += copy.getShipsCount();
+            }
+            double seconds = secondsSince(start);
+            benchSink = benchSink + ships;
+            return seconds;
+        }});
+
+        // копия поля и один выстрел по ней: выстрелы не трогают общую расстановку
+        benchmarks.push_back({"field_clone_attack", 50000, [](long long operations) {
+            Field source = placedField();
+            std::vector<std::pair<int, int>> cells = shuffledCells(source.getSize());
+            long long hits = 0;
+            auto start = Clock::now();
+            for (long long i = 0; i < operations; i++) {
+                Field copy(source);
+                const std::pair<int, int>& cell = cells[i % cells.size()];
+                hits += copy.attack(cell.first, cell.second) != Field::AttackResult::Miss;
+            }
+            double seconds = secondsSince(start);
+            benchSink = benchSink + hits;
+            return seconds;
+        }});
+        
+        // снимок в готовый объект и откат: так перебор ходов возвращает поле назад
+        benchmarks.push_back({"field_snapshot_restore", 100000, [](long long operations) {
+            Field field = placedField();
+            Field::Snapshot snapshot = field.snapshot();
+            std::vector<std::pair<int, int>> cells = shuffledCells(field.getSize());
+            long long hits = 0;
+            double seconds = 0.0;
+            long long done = 0;
+            while (done < operations) {
+                long long batch = std::min<long long>(cells.size(), operations - done);
+                auto start = Clock::now();
+                for (long long i = 0; i < batch; i++) {
+                    field.saveSnapshot(snapshot);
+                    hits += field.attack(cells[i].first, cells[i].second) != Field::AttackResult::Miss;
+                    field.restore(snapshot);
+                }
+                seconds += secondsSince(start);
+                done += batch;
+            }
+            benchSink = benchSink + hits;
+            return seconds;
+        }});
+
+        // обратимый выстрел и откат на месте, без копии поля
+        benchmarks.push_back({"field_attack_undo", 100000, [](long long operations) {
+            Field field = placedField();
+            std::vector<std::pair<int, int>> cells = shuffledCells(field.getSize());
+            Field::AttackUndo undo;
+            long long hits = 0;
+            double seconds = 0.0;
+            long long done = 0;
+            while (done < operations) {
+                long long batch = std::min<long long>(cells.size(), operations - done);
+                auto start = Clock::now();
+                for (long long i = 0; i < batch; i++) {
+                    hits += field.attack(cells[i].first, cells[i].second, undo) != Field::AttackResult::Miss;
+                    field.undo(undo);
+                }
+                seconds += secondsSince(start);
+                done += batch;
+            }
+            benchSink = benchSink + hits;
+            return seconds;
+        }});
+
+        // ход компьютера с обработкой результата, поле обстреливается целиком
+        benchmarks.push_back({"computer_make_move", 100000, [](long long operations) {
+            ComputerPlayer computer("Компьютер");
+            Field target;
+            int cells = target.getSize() * target.getSize();
+            double seconds = 0.0;
+            long long done = 0;
+            while (done < operations) {
+                computer.reset();
+                target.reset();
+                target.placeAllShipsAuto();
+                long long batch = std::min<long long>(cells, operations - done);
+                auto start = Clock::now();
+                for (long long i = 0; i < batch; i++) {
+                    std::pair<int, int> shot = computer.makeMove();
+                    computer.onAttackResult(shot.first, shot.second, target.attack(shot.first, shot.second));
+                }
+                seconds += secondsSince(start);
+                done += batch;
+            }
+            return seconds;
+        }});
+
+        // ход по плотности без кэша и с таблицей транспозиций, прогретой предыдущими партиями
+        benchmarks.push_back({"density_make_move", 20000, [](long long operations) {
+            return densityMoves(operations, nullptr);
+        }});
+        
+        benchmarks.push_back({"density_make_move_tt", 20000, [](long long operations) {
+            static TranspositionTable table(16);
+            return densityMoves(operations, &table);
+        }});
+        
+        // партия компьютер против компьютера целиком, включая расстановку
+        benchmarks.push_back({"headless_game", 2000, [](long long operations) {
+            Game game(TargetingStrategy::HuntTarget, TargetingStrategy::HuntTarget);
+            long long turns = 0;
+            auto start = Clock::now();
+            for (long long i = 0; i < operations; i++) {
+                turns += game.runHeadless().turns;
+            }
+            double seconds = secondsSince(start);
+            benchSink = benchSink + turns;
+            return seconds;
+        }});
+
+        return benchmarks;
+    }
+
+    // выделения памяти за партии двух компьютеров
+    struct AllocationCheck {
+        std::string name;
+        long long games;
+        long long allocations;  // за runHeadless целиком: сброс, расстановка и ходы
+    };
+    
+    // считается сам Game::runHeadless(seed) после подготовки: игра создана, 
+    // первая партия прогревает кэши генератора флота и в счёт не входит
+    AllocationCheck countPlayAllocations(const std::string& name, TargetingStrategy strategy1, 
+                                         TargetingStrategy strategy2, long long games, uint64_t seed) {
+        Game game(strategy1, strategy2);
+        AllocationCheck check = {name, games, 0};
+        
+        game.runHeadless(seed);
+        for (long long i = 0; i < games; i++) {
+            long long before = allocationCount.load(std::memory_order_relaxed);
+            GameResult result = game.runHeadless(seed + 1 + static_cast<uint64_t>(i));
+            check.allocations += allocationCount.load(std::memory_order_relaxed) - before;
+            benchSink = benchSink + result.turns;
+        }
+        return check;
+    }
+    
+    std::vector<AllocationCheck> runAllocationChecks(long long games, uint64_t seed) {
+        return {
+            countPlayAllocations("game_hunt_vs_hunt", TargetingStrategy::HuntTarget, TargetingStrategy::HuntTarget, games, seed),
+            countPlayAllocations("game_density_vs_hunt", TargetingStrategy::Density, TargetingStrategy::HuntTarget, games, seed)
+        };
+    }
+    
+    // всё, что меняет выстрел: хеш, число потопленных, подбитые палубы каждого корабля
+    // и состояние каждой клетки (попадания, промахи, открытый ореол, потопленные палубы)
+    std::string fieldState(const Field& field) {
+        std::string state = std::to_string(field.getHash()) + "/" + std::to_string(field.getDestroyedShipsCount()) + "/";
+        for (int ship = 0; ship < field.getShipsCount(); ship++) {
+            state += static_cast<char>('0' + field.getShipHitCount(ship));
+        }
+        state += "/";
+        for (int y = 0; y < field.getSize(); y++) {
+            for (int x = 0; x < field.getSize(); x++) {
+                state += static_cast<char>('0' + static_cast<int>(field.getCellState(x, y)));
+            }
+        }
+        return state;
+    }
+    
+    // attack(x, y, undo) + undo() должны возвращать поле бит в бит: на каждой позиции
+    // партии стек из нескольких выстрелов (повторы, потопления с ореолом) откатывается
+    // и состояние сверяется на каждом уровне; возвращает число расхождений
+    long long checkAttackUndo(long long games) {
+        const int DEPTH = 6;
+        long long mismatches = 0;
+        Field::AttackUndo undos[DEPTH];
+        std::string states[DEPTH];
+        Rng& generator = threadRng();
+        
+        for (long long game = 0; game < games; game++) {
+            Field field = placedField();
+            std::vector<std::pair<int, int>> cells = shuffledCells(field.getSize());
+            int cellCount = static_cast<int>(cells.size());
+            for (int shot = 0; shot < cellCount && !field.allShipsDestroyed(); shot++) {
+                for (int depth = 0; depth < DEPTH; depth++) {
+                    states[depth] = fieldState(field);
+                    // следующие клетки партии и иногда уже обстрелянные
+                    const std::pair<int, int>& cell = cells[generator.below(4) == 0 
+                        ? generator.below(cellCount) : std::min(shot + depth, cellCount - 1)];
+                    field.attack(cell.first, cell.second, undos[depth]);
+                }
+                for (int depth = DEPTH - 1; depth >= 0; depth--) {
+                    field.undo(undos[depth]);
+                    mismatches += fieldState(field) != states[depth];
+                }
+                field.attack(cells[shot].first, cells[shot].second);
+            }
+        }
+        return mismatches;
+    }
+    
+    // таблица транспозиций не должна менять партий: турнир с зерном и общей таблицей
+    // на нескольких потоках играется так же, как без неё; false - итоги разошлись
+    bool checkTableDeterminism(long long games, uint64_t seed) {
+        const int THREADS = 4;
+        Tournament plain(THREADS, TargetingStrategy::Density, TargetingStrategy::Density);
+        SimulationStats expected = plain.play(games, seed);
+        
+        TranspositionTable table(16);
+        Tournament cached(THREADS, TargetingStrategy::Density, TargetingStrategy::Density);
+        cached.setTranspositionTable(&table);
+        // второй прогон идёт по таблице, заполненной первым
+        for (int run = 0; run < 2; run++) {
+            SimulationStats stats = cached.play(games, seed);
+            if (stats.player1Wins != expected.player1Wins || stats.winnerShots != expected.winnerShots) return false;
+        }
+        return true;
+    }
+    
+    std::string jsonEscape(const std::string& text) {
+        std::string escaped;
+        for (char c : text) {
+            if (c == '"' || c == '\\') escaped += '\\';
+            escaped += c;
+        }
+        return escaped;
+    }
+
+    void writeJson(std::ostream& os, const std::vector<BenchResult>& results, 
+                   const std::vector<AllocationCheck>& allocations, const BenchOptions& options) {
+        os << std::fixed << std::setprecision(3);
+        os << "{\n";
+        os << "  \"compiler\": \"" << jsonEscape(__VERSION__) << "\",\n";
+        os << "  \"build_date\": \"" << __DATE__ << " " << __TIME__ << "\",\n";
+        os << "  \"hardware_threads\": " << std::thread::hardware_concurrency() << ",\n";
+        os << "  \"warmup\": " << options.warmup << ",\n";
+        os << "  \"repetitions\": " << options.repetitions << ",\n";
+        os << "  \"seed\": " << options.seed << ",\n";
+        os << "  \"benchmarks\": [\n";
+        for (size_t i = 0; i < results.size(); i++) {
+            const BenchResult& r = results[i];
+            os << "    {\"name\": \"" << r.name << "\", \"operations\": " << r.operations
+               << ", \"repetitions\": " << r.repetitions
+               << ", \"min_ns\": " << r.minNs << ", \"median_ns\": " << r.medianNs
+               << ", \"mean_ns\": " << r.meanNs << ", \"max_ns\": " << r.maxNs
+               << ", \"stddev_ns\": " << r.stddevNs << "}"
+               << (i + 1 < results.size() ? "," : "") << "\n";
+        }
+        os << "  ],\n";
+        os << "  \"allocations\": [\n";
+        for (size_t i = 0; i < allocations.size(); i++) {
+            const AllocationCheck& check = allocations[i];
+            os << "    {\"name\": \"" << check.name << "\", \"games\": " << check.games
+               << ", \"allocations\": " << check.allocations << "}"
+               << (i + 1 < allocations.size() ? "," : "") << "\n";
+        }
+        os << "  ]\n";
+        os << "}\n";
+    }
+
+    // медианы из JSON, записанного writeJson: по одному замеру на строку
+    bool readBaseline(const std::string& path, std::map<std::string, double>& medians) {
+        std::ifstream in(path);
+        if (!in) return false;
+
+        std::string line;
+        while (std::getline(in, line)) {
+            size_t name = line.find("\"name\": \"");
+            size_t median = line.find("\"median_ns\": ");
+            if (name == std::string::npos || median == std::string::npos) continue;
+            name += 9;
+            size_t nameEnd = line.find('"', name);
+            medians[line.substr(name, nameEnd - name)] = std::stod(line.substr(median + 13));
+        }
+        return true;
+    }
+
+    void printTable(std::ostream& os, const std::vector<BenchResult>& results) {
+        // setw считает байты, поэтому заголовок выровнен вручную
+        os << "Замер" << std::string(23, ' ')
+           << "     мин, нс     медиана     среднее     разброс\n";
+        os << std::fixed << std::setprecision(1);
+        for (const BenchResult& r : results) {
+            os << std::left << std::setw(28) << r.name << std::right
+               << std::setw(12) << r.minNs << std::setw(12) << r.medianNs
+               << std::setw(12) << r.meanNs << std::setw(12) << r.stddevNs << "\n";
+        }
+    }
+
+    // сравнение медиан с прошлым прогоном, false - есть замедление сверх допуска
+    bool compareWithBaseline(std::ostream& os, const std::vector<BenchResult>& results,
+                             const std::map<std::string, double>& baseline, double tolerance) {
+        bool ok = true;
+        os << "\nСравнение с базой (допуск " << std::setprecision(0) << tolerance * 100 << "%)\n";
+        os << std::setprecision(1);
+        for (const BenchResult& r : results) {
+            auto it = baseline.find(r.name);
+            if (it == baseline.end() || it->second <= 0.0) continue;
+            double ratio = r.medianNs / it->second;
+            bool regressed = ratio > 1.0 + tolerance;
+            ok = ok && !regressed;
+            os << std::left << std::setw(28) << r.name << std::right
+               << std::setw(12) << it->second << " -> " << std::setw(10) << r.medianNs
+               << std::setw(9) << std::setprecision(2) << ratio << "x" << std::setprecision(1)
+               << (regressed ? "  ЗАМЕДЛЕНИЕ" : "") << "\n";
+        }
+        return ok;
+    }
+
+    void printUsage(const char* program) {
+        std::cerr << "Использование: " << program << " [параметры]\n"
+                  << "  --warmup N        прогревочных повторов (по умолчанию 3)\n"
+                  << "  --reps N          замеряемых повторов (по умолчанию 15)\n"
+                  << "  --scale X         множитель числа операций в повторе\n"
+                  << "  --seed N          зерно генератора\n"
+                  << "  --filter ТЕКСТ    только замеры, имя которых содержит текст\n"
+                  << "  --json ФАЙЛ       записать результаты в JSON (\"-\" - в stdout)\n"
+                  << "  --baseline ФАЙЛ   сравнить медианы с прошлым JSON\n"
+                  << "  --tolerance X     допустимое замедление, доля (по умолчанию 0.10)\n"
+                  << "Код возврата: 2 - замедление относительно базы, 3 - партия выделяет память,\n"
+                  << "               4 - откат выстрела не восстанавливает поле,\n"
+                  << "               5 - таблица транспозиций меняет итоги турнира с зерном\n";
+    }
+}
+
+int main(int argc, char* argv[]) {
+    BenchOptions options;
+    try {
+        for (int i = 1; i < argc; i++) {
+            std::string arg = argv[i];
+            if (i + 1 >= argc) throw std::invalid_argument(arg);
+            std::string value = argv[++i];
+
+            if (arg == "--warmup") {
+                options.warmup = std::stoi(value);
+            } else if (arg == "--reps") {
+                options.repetitions = std::max(1, std::stoi(value));
+            } else if (arg == "--scale") {
+                options.scale = std::stod(value);
+            } else if (arg == "--seed") {
+                options.seed = static_cast<unsigned>(std::stoul(value));
+            } else if (arg == "--filter") {
+                options.filter = value;
+            } else if (arg == "--json") {
+                options.jsonPath = value;
+            } else if (arg == "--baseline") {
+                options.baselinePath = value;
+            } else if (arg == "--tolerance") {
+                options.tolerance = std::stod(value);
+            } else {
+                throw std::invalid_argument(arg);
+            }
+        }
+    } catch (...) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    // при выводе JSON в stdout таблица уходит в stderr
+    std::ostream& report = options.jsonPath == "-" ? std::cerr : std::cout;
+
+    std::vector<BenchResult> results;
+    for (const Benchmark& bench : makeBenchmarks()) {
+        if (!options.filter.empty() && bench.name.find(options.filter) == std::string::npos) continue;
+        seedThreadRng(options.seed);
+        results.push_back(runBenchmark(bench, options));
+    }
+    printTable(report, results);
+    
+    // партия не должна выделять память ни во время ходов, ни при повторной расстановке
+    const long long ALLOCATION_CHECK_GAMES = 200;
+    std::vector<AllocationCheck> allocations = runAllocationChecks(ALLOCATION_CHECK_GAMES, options.seed);
+    bool allocationFree = true;
+    report << "\nВыделений памяти за " << ALLOCATION_CHECK_GAMES << " партий Game::runHeadless:\n";
+    for (const AllocationCheck& check : allocations) {
+        report << "  " << check.name << ": " << check.allocations << "\n";
+        allocationFree = allocationFree && check.allocations == 0;
+    }
+    
+    const long long UNDO_CHECK_GAMES = 200;
+    long long undoMismatches = checkAttackUndo(UNDO_CHECK_GAMES);
+    report << "Расхождений после отката выстрелов за " << UNDO_CHECK_GAMES << " партий: " << undoMismatches << "\n";
+    
+    const long long TABLE_CHECK_GAMES = 1000;
+    bool tableDeterministic = checkTableDeterminism(TABLE_CHECK_GAMES, options.seed);
+    report << "Турнир с таблицей транспозиций за " << TABLE_CHECK_GAMES << " партий: " 
+           << (tableDeterministic ? "совпадает" : "расходится") << " с турниром без неё\n";
+
+    if (options.jsonPath == "-") {
+        writeJson(std::cout, results, allocations, options);
+    } else if (!options.jsonPath.empty()) {
+        std::ofstream out(options.jsonPath);
+        if (!out) {
+            std::cerr << "Не удалось записать " << options.jsonPath << "\n";
+            return 1;
+        }
+        writeJson(out, results, allocations, options);
+    }
+
+    if (!options.baselinePath.empty()) {
+        std::map<std::string, double> baseline;
+        if (!readBaseline(options.baselinePath, baseline)) {
+            std::cerr << "Не удалось прочитать " << options.baselinePath << "\n";
+            return 1;
+        }
+        if (!compareWithBaseline(report, results, baseline, options.tolerance)) {
+            return 2;
+        }
+    }
+    
+    if (!allocationFree) {
+        std::cerr << "Партия выделяет память\n";
+        return 3;
+    }
+    if (undoMismatches > 0) {
+        std::cerr << "Откат выстрела не восстанавливает поле\n";
+        return 4;
+    }
+    if (!tableDeterministic) {
+        std::cerr << "Таблица транспозиций меняет ходы\n";
+        return 5;
+    }
+    return 0;
+}
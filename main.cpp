@@ -1,9 +1,39 @@
 #include "Game.h"
 #include "Graphics.h"
 #include <iostream>
+#include <string>
 
-int main() {
-    GameGUI gui;
+int main(int argc, char* argv[]) {
+    // размер поля и флот: --size N --fleet "4x1,3x2,2x3,1x4"; --seed N - повторяемые партии
+    BoardConfig config;
+    try {
+        for (int i = 1; i < argc; i++) {
+            std::string arg = argv[i];
+            if (i + 1 >= argc) throw std::invalid_argument(arg);
+            std::string value = argv[++i];
+
+            if (arg == "--size") {
+                config.size = std::stoi(value);
+            } else if (arg == "--fleet") {
+                if (!BoardConfig::parseFleet(value, config.fleet)) throw std::invalid_argument(value);
+            } else if (arg == "--seed") {
+                // расстановки и генератор компьютера засеваются из генератора главного потока
+                seedThreadRng(std::stoull(value));
+            } else {
+                throw std::invalid_argument(arg);
+            }
+        }
+        if (!config.isValid() || config.size > GameConfig::MAX_FIELD_SIZE) {
+            throw std::invalid_argument("config");
+        }
+    } catch (...) {
+        std::cerr << "Использование: " << argv[0] << " [--size N] [--fleet СПИСОК] [--seed N]\n"
+                  << "  размер поля от 1 до " << GameConfig::MAX_FIELD_SIZE
+                  << ", флот: \"4,3,3,2\" или \"4x1,3x2,2x3,1x4\"\n";
+        return 1;
+    }
+
+    GameGUI gui(config);
     if (gui.initialize()) {
         gui.run();
     } else {
@@ -11,4 +41,4 @@ int main() {
         return 1;
     }
     return 0;
-}
\ No newline at end of file
+}
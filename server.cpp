@@ -0,0 +1,394 @@
+#include "GameServer.h"
+#include "Simulation.h"
+#include <iostream>
+#include <string>
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <cerrno>
+#include <algorithm>
+#include <fstream>
+#include <functional>
+#include <malloc.h>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+    GameServer* runningServer = nullptr;
+    
+    void onSignal(int) {
+        if (runningServer) runningServer->stop();
+    }
+    
+    void printUsage(const char* program) {
+        std::cerr << "Использование:\n"
+                  << "  " << program << " [параметры]                      - сервер партий до Ctrl+C\n"
+                  << "  " << program << " load [соединений] [параметры]    - нагрузка на запущенный сервер\n"
+                  << "  " << program << " bench [соединений] [параметры]   - сервер и нагрузка в одном процессе\n"
+                  << "  " << program << " memory [партий] [параметры]      - память на одну живую партию\n"
+                  << "Параметры:\n"
+                  << "  --host АДРЕС       адрес сервера (по умолчанию 127.0.0.1)\n"
+                  << "  --port N           порт (по умолчанию 7777, 0 - любой свободный)\n"
+                  << "  --threads N        потоков сервера (0 - все ядра, по умолчанию 1)\n"
+                  << "  --ai hunt|density  стратегия компьютера\n"
+                  << "  --size N           размер поля (по умолчанию 10)\n"
+                  << "  --fleet СПИСОК     флот: \"4,3,3,2\" или \"4x1,3x2,2x3,1x4\"\n"
+                  << "  --seed N           зерно партий сервера\n"
+                  << "  --seconds N        длительность нагрузки (по умолчанию 10)\n";
+    }
+    
+    // десятки тысяч соединений не помещаются в обычный лимит дескрипторов
+    void raiseDescriptorLimit() {
+        rlimit limit;
+        if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max) {
+            limit.rlim_cur = limit.rlim_max;
+            setrlimit(RLIMIT_NOFILE, &limit);
+        }
+    }
+    
+    void printLatency(const char* title, const LatencyHistogram& latency) {
+        std::cout << title << " p50 / p99 / макс, мкс: "
+                  << latency.percentile(0.5) / 1000.0 << " / "
+                  << latency.percentile(0.99) / 1000.0 << " / "
+                  << latency.max() / 1000.0 << "\n";
+    }
+    
+    void printServerStats(const GameServer& server) {
+        GameServer::Stats stats = server.getStats();
+        std::cout << "Соединений принято:    " << stats.connections << "\n";
+        std::cout << "Партий начато:         " << stats.games << "\n";
+        std::cout << "Запросов:              " << stats.requests << "\n";
+        printLatency("Обработка запроса", stats.latency);
+    }
+    
+    // занятая куча (glibc) и резидентная память процесса
+    struct MemoryUsage {
+        size_t heap;
+        size_t resident;
+    };
+    
+    MemoryUsage currentMemory() {
+        MemoryUsage usage{mallinfo2().uordblks, 0};
+        std::ifstream statm("/proc/self/statm");
+        size_t pages = 0, residentPages = 0;
+        if (statm >> pages >> residentPages) {
+            usage.resident = residentPages * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        }
+        return usage;
+    }
+    
+    // count партий в середине игры (флоты расставлены, по несколько выстрелов с каждой стороны),
+    // как их держит сервер: указатель на партию и сама партия
+    void measureSessions(const char* title, long long count,
+                         const std::function<std::unique_ptr<GameSession>(uint64_t)>& create, int size) {
+        MemoryUsage before = currentMemory();
+        std::vector<std::unique_ptr<GameSession>> sessions;
+        sessions.reserve(count);
+        Rng rng(count);
+        std::string reply;
+        for (long long i = 0; i < count; i++) {
+            sessions.push_back(create(static_cast<uint64_t>(i)));
+            GameSession& session = *sessions.back();
+            if (!session.hasComputerFleet() || !session.placeAllShips()) {
+                std::cout << title << " флот не помещается на поле\n";
+                return;
+            }
+            session.start();
+            for (int shot = 0; shot < 5; shot++) {
+                reply.clear();
+                session.shoot(rng.below(size), rng.below(size), reply);
+            }
+        }
+        MemoryUsage after = currentMemory();
+        
+        std::cout << title << "\n";
+        std::cout << "  Партий:              " << count << "\n";
+        std::cout << "  Куча на партию, Б:   " << static_cast<double>(after.heap - before.heap) / count << "\n";
+        std::cout << "  Память процесса на партию, Б: " 
+                  << static_cast<double>(after.resident - before.resident) / count << "\n";
+        std::cout << "  Всего, МБ:           " << (after.heap - before.heap) / (1024.0 * 1024.0) << "\n";
+    }
+    
+    // нагрузочный клиент: соединения играют партии подряд, стреляя по клеткам в случайном порядке;
+    // у каждого соединения один запрос в пути, задержка - от отправки до ответа
+    class LoadClient {
+    private:
+        enum class Step { New, Auto, Start, Shot };
+        
+        struct Session {
+            int fd = -1;
+            Step step = Step::New;
+            std::string input;
+            std::vector<int> cells;  // порядок выстрелов партии
+            size_t nextCell = 0;
+            std::chrono::steady_clock::time_point sent;
+        };
+        
+        std::vector<Session> sessions;
+        Rng rng;
+        int epollFd;
+        int boardSize;
+        bool stopping;
+        
+        long long requests;
+        long long games;
+        long long failures;
+        LatencyHistogram latency;
+        
+        bool send(Session& session, const std::string& line) {
+            session.sent = std::chrono::steady_clock::now();
+            ssize_t written = ::send(session.fd, line.data(), line.size(), MSG_NOSIGNAL);
+            return written == static_cast<ssize_t>(line.size());
+        }
+        
+        void close(Session& session) {
+            epoll_ctl(epollFd, EPOLL_CTL_DEL, session.fd, nullptr);
+            ::close(session.fd);
+            session.fd = -1;
+            failures++;
+        }
+        
+        // ответ на запрос в пути и следующий запрос
+        bool onReply(Session& session, const std::string& reply) {
+            auto now = std::chrono::steady_clock::now();
+            latency.record(static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(now - session.sent).count()));
+            requests++;
+            if (stopping) return true;
+            if (reply.compare(0, 3, "ERR") == 0) return false;
+            
+            switch (session.step) {
+                case Step::New:
+                    session.step = Step::Auto;
+                    return send(session, "AUTO\n");
+                case Step::Auto:
+                    session.step = Step::Start;
+                    return send(session, "START\n");
+                case Step::Start:
+                    std::shuffle(session.cells.begin(), session.cells.end(), rng);
+                    session.nextCell = 0;
+                    session.step = Step::Shot;
+                    break;
+                case Step::Shot: {
+                    bool finished = reply == "WIN" ||
+                                    (reply.size() >= 4 && reply.compare(reply.size() - 4, 4, "LOSE") == 0);
+                    if (finished || session.nextCell == session.cells.size()) {
+                        games += finished;
+                        session.step = Step::New;
+                        return send(session, "NEW\n");
+                    }
+                    break;
+                }
+            }
+            
+            int cell = session.cells[session.nextCell++];
+            return send(session, "SHOT " + std::to_string(cell % boardSize) + " " + 
+                                 std::to_string(cell / boardSize) + "\n");
+        }
+        
+        void onReadable(Session& session) {
+            char buffer[4096];
+            while (true) {
+                ssize_t received = ::read(session.fd, buffer, sizeof(buffer));
+                if (received > 0) {
+                    session.input.append(buffer, static_cast<size_t>(received));
+                    continue;
+                }
+                if (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+                if (received < 0 && errno == EINTR) continue;
+                close(session);
+                return;
+            }
+            
+            size_t end;
+            while ((end = session.input.find('\n')) != std::string::npos) {
+                std::string reply = session.input.substr(0, end);
+                session.input.erase(0, end + 1);
+                if (!onReply(session, reply)) {
+                    close(session);
+                    return;
+                }
+            }
+        }
+    
+    public:
+        LoadClient(int connections, int boardSize, uint64_t seed)
+            : sessions(connections), rng(seed), epollFd(epoll_create1(EPOLL_CLOEXEC)),
+              boardSize(boardSize), stopping(false), requests(0), games(0), failures(0) {}
+        
+        ~LoadClient() {
+            for (Session& session : sessions) {
+                if (session.fd >= 0) ::close(session.fd);
+            }
+            ::close(epollFd);
+        }
+        
+        // false - не удалось открыть соединения
+        bool run(const std::string& host, int port, double seconds) {
+            sockaddr_in address{};
+            address.sin_family = AF_INET;
+            address.sin_port = htons(static_cast<uint16_t>(port));
+            if (inet_pton(AF_INET, host.c_str(), &address.sin_addr) != 1) return false;
+            
+            auto connectStart = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < sessions.size(); i++) {
+                Session& session = sessions[i];
+                session.fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+                if (session.fd < 0 || connect(session.fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+                    std::cerr << "Соединение " << i << ": " << std::strerror(errno) << "\n";
+                    return false;
+                }
+                int enable = 1;
+                setsockopt(session.fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+                fcntl(session.fd, F_SETFL, fcntl(session.fd, F_GETFL) | O_NONBLOCK);
+                
+                epoll_event event{};
+                event.events = EPOLLIN;
+                event.data.u64 = i;
+                epoll_ctl(epollFd, EPOLL_CTL_ADD, session.fd, &event);
+                
+                session.cells.resize(static_cast<size_t>(boardSize) * boardSize);
+                for (size_t cell = 0; cell < session.cells.size(); cell++) session.cells[cell] = static_cast<int>(cell);
+            }
+            double connectSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - connectStart).count();
+            
+            auto start = std::chrono::steady_clock::now();
+            for (Session& session : sessions) {
+                if (!send(session, "NEW\n")) close(session);
+            }
+            
+            epoll_event events[256];
+            auto deadline = start + std::chrono::duration<double>(seconds);
+            while (std::chrono::steady_clock::now() < deadline) {
+                int count = epoll_wait(epollFd, events, 256, 100);
+                for (int i = 0; i < count; i++) {
+                    Session& session = sessions[events[i].data.u64];
+                    if (session.fd >= 0) onReadable(session);
+                }
+            }
+            stopping = true;
+            double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            
+            std::cout << "Соединений:            " << sessions.size()
+                      << " (открыты за " << connectSeconds << " с)\n";
+            std::cout << "Оборвано:              " << failures << "\n";
+            std::cout << "Партий сыграно:        " << games << "\n";
+            std::cout << "Запросов:              " << requests << "\n";
+            std::cout << "Запросов в секунду:    " << (elapsed > 0.0 ? requests / elapsed : 0.0) << "\n";
+            printLatency("Запрос-ответ", latency);
+            return true;
+        }
+    };
+}
+
+int main(int argc, char* argv[]) {
+    std::string mode = "serve";
+    int argIndex = 1;
+    if (argc > 1) {
+        std::string first = argv[1];
+        if (first == "load" || first == "bench" || first == "memory") {
+            mode = first;
+            argIndex = 2;
+        }
+    }
+    
+    GameServer::Options options;
+    long long count = 0;  // соединений для load и bench, партий для memory; 0 - по умолчанию
+    double seconds = 10.0;
+    
+    try {
+        if (mode != "serve" && argc > argIndex && argv[argIndex][0] != '-') {
+            count = std::stoll(argv[argIndex++]);
+            if (count < 1) throw std::invalid_argument("count");
+        }
+        for (int i = argIndex; i < argc; i++) {
+            std::string arg = argv[i];
+            if (i + 1 >= argc) throw std::invalid_argument(arg);
+            std::string value = argv[++i];
+            
+            if (arg == "--host") {
+                options.host = value;
+            } else if (arg == "--port") {
+                options.port = std::stoi(value);
+            } else if (arg == "--threads") {
+                options.threads = std::stoi(value);
+            } else if (arg == "--ai") {
+                if (!parseStrategy(value, options.strategy)) throw std::invalid_argument(value);
+            } else if (arg == "--size") {
+                options.config.size = std::stoi(value);
+            } else if (arg == "--fleet") {
+                if (!BoardConfig::parseFleet(value, options.config.fleet)) throw std::invalid_argument(value);
+            } else if (arg == "--seed") {
+                options.seed = std::stoull(value);
+            } else if (arg == "--seconds") {
+                seconds = std::stod(value);
+            } else {
+                throw std::invalid_argument(arg);
+            }
+        }
+        if (!options.config.isValid()) throw std::invalid_argument("config");
+    } catch (...) {
+        printUsage(argv[0]);
+        return 1;
+    }
+    
+    raiseDescriptorLimit();
+    int connections = count > 0 ? static_cast<int>(count) : 1000;
+    
+    if (mode == "memory") {
+        long long games = count > 0 ? count : 1000000;
+        const BoardConfig& config = options.config;
+        TargetingStrategy strategy = options.strategy;
+        int size = config.size;
+        if (CompactGameSession::supports(config, strategy)) {
+            measureSessions("Компактные партии:", games, [&](uint64_t seed) {
+                return std::unique_ptr<GameSession>(new CompactGameSession(config, seed));
+            }, size);
+        } else {
+            std::cout << "Компактные партии не поддерживают это поле, флот или стратегию\n";
+        }
+        // партии на объектах движка в десятки раз больше: их меньше, чтобы уложиться в память
+        measureSessions("Партии на объектах движка:", std::min(games, 100000LL), [&](uint64_t seed) {
+            return std::unique_ptr<GameSession>(new EngineGameSession(config, strategy, seed));
+        }, size);
+        return 0;
+    }
+    
+    if (mode == "load") {
+        LoadClient client(connections, options.config.size, options.seed);
+        return client.run(options.host, options.port, seconds) ? 0 : 1;
+    }
+    
+    if (mode == "bench") options.port = 0;
+    GameServer server(options);
+    if (!server.start()) {
+        std::cerr << "Не удалось запустить сервер: " << server.getError() << "\n";
+        return 1;
+    }
+    std::cout << "Сервер на " << options.host << ":" << server.getPort()
+              << ", потоков: " << server.getThreadCount() << "\n";
+    
+    if (mode == "bench") {
+        LoadClient client(connections, options.config.size, options.seed + 1);
+        bool loaded = client.run(options.host, server.getPort(), seconds);
+        server.stop();
+        server.wait();
+        printServerStats(server);
+        return loaded ? 0 : 1;
+    }
+    
+    runningServer = &server;
+    std::signal(SIGINT, onSignal);
+    std::signal(SIGTERM, onSignal);
+    server.wait();
+    runningServer = nullptr;
+    printServerStats(server);
+    return 0;
+}
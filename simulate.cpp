@@ -0,0 +1,789 @@
+#include "Simulation.h"
+#include "Tournament.h"
+#include "Field.h"
+#include "FleetGenerator.h"
+#include "PosteriorSampler.h"
+#include "Player.h"
+#include "Random.h"
+#include "TranspositionTable.h"
+#include "GameRecord.h"
+#include "Thumbnail.h"
+#include <iostream>
+#include <string>
+#include <chrono>
+#include <iomanip>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    void printUsage(const char* program) {
+        std::cerr << "Использование:\n"
+                  << "  " << program << " [партий] [параметры]            - прогон в одном потоке\n"
+                  << "  " << program << " tournament [партий] [параметры] - турнир на всех ядрах\n"
+                  << "  " << program << " layouts [расстановок]           - скорость расстановки флота\n"
+                  << "  " << program << " uniformity [расстановок]        - равномерность расстановок по числу проходов Гиббса\n"
+                  << "  " << program << " posterior [позиций]             - выборка расстановок по наблюдению\n"
+                  << "  " << program << " moves [ходов]                   - цена хода компьютера на полях разного размера\n"
+                  << "  " << program << " large [выстрелов]               - память и цена выстрела на огромных полях\n"
+                  << "  " << program << " replay --seed N [параметры]     - повтор одной партии по её зерну\n"
+                  << "  " << program << " records --record ФАЙЛ           - чтение записанных партий\n"
+                  << "  " << program << " thumbnails [партий] --record ФАЙЛ --out КАТАЛОГ - миниатюры записанных партий\n"
+                  << "Параметры:\n"
+                  << "  --threads N        число потоков турнира (0 - все ядра)\n"
+                  << "  --p1 hunt|density  стратегия первого компьютера\n"
+                  << "  --p2 hunt|density  стратегия второго компьютера\n"
+                  << "  --size N           размер поля (по умолчанию 10)\n"
+                  << "  --fleet СПИСОК     флот: \"4,3,3,2\" или \"4x1,3x2,2x3,1x4\"\n"
+                  << "  --seed N           зерно: одинаковое зерно даёт одинаковые партии\n"
+                  << "  --record ФАЙЛ      записать сыгранные партии (без режима; в records и thumbnails - прочитать)\n"
+                  << "  --tt МБ            таблица транспозиций для стратегии плотности (0 - без неё)\n"
+                  << "  --out КАТАЛОГ      каталог миниатюр\n"
+                  << "  --cell ПИКСЕЛЕЙ    размер клетки миниатюры (по умолчанию 6)\n"
+                  << "  --format png|ppm   формат миниатюр\n"
+                  << "  --position K       миниатюра позиции после K выстрелов (по умолчанию - конец партии)\n";
+    }
+    
+    void benchmarkLayouts(long long count, const BoardConfig& config) {
+        Field field(config);
+        long long ships = 0;
+        
+        auto start = std::chrono::steady_clock::now();
+        for (long long i = 0; i < count; i++) {
+            field.placeAllShipsAuto();
+            ships += field.getShipsCount();
+        }
+        auto finish = std::chrono::steady_clock::now();
+        
+        double seconds = std::chrono::duration<double>(finish - start).count();
+        std::cout << "Расстановок:            " << count << "\n";
+        std::cout << "Кораблей на поле:       " << (count > 0 ? ships / count : 0) << "\n";
+        std::cout << "Время, с:               " << seconds << "\n";
+        std::cout << "Расстановок в секунду:  " << (seconds > 0.0 ? count / seconds : 0.0) << "\n";
+    }
+    
+    // ограничения полного перебора: клетки, где могут стоять корабли, и попадания, которые
+    // корабли должны накрыть (ни один корабль не подбит целиком); поле до 8x8 - одно слово
+    struct LayoutConstraints {
+        uint64_t allowed;
+        uint64_t hits;
+    };
+    
+    // все расстановки флота полным перебором; расстановка задаётся маской палуб
+    // (корабли не касаются, поэтому маска однозначна), корабли одной длины не различаются -
+    // их положения перебираются по возрастанию
+    void enumerateLayouts(const PlacementMasks& masks, const std::vector<int>& fleet, 
+                          const LayoutConstraints& constraints, size_t ship, int previousKey, 
+                          const Bitboard& occupied, std::vector<uint64_t>& layouts) {
+        if (ship == fleet.size()) {
+            if ((constraints.hits & ~occupied.getWord(0)) == 0) layouts.push_back(occupied.getWord(0));
+            return;
+        }
+        
+        int length = fleet[ship];
+        bool sameAsPrevious = ship > 0 && fleet[ship - 1] == length;
+        Bitboard free = masks.dilate(occupied);
+        free.setWord(0, constraints.allowed & ~free.getWord(0));
+        Bitboard hits(occupied.size());
+        hits.setWord(0, constraints.hits);
+        
+        Bitboard starts(occupied.size());
+        Bitboard fullyHit(occupied.size());
+        Bitboard cells(occupied.size());
+        // у однопалубного корабля оба направления дают одно положение
+        for (int orientation = 0; orientation < (length > 1 ? 2 : 1); orientation++) {
+            masks.legalStarts(free, length, orientation == 1, starts);
+            masks.legalStarts(hits, length, orientation == 1, fullyHit);
+            starts.andNot(fullyHit);
+            starts.forEachSetBit([&](int start) {
+                int key = start * 2 + orientation;
+                if (sameAsPrevious && key <= previousKey) return;
+                masks.shipMask(start, length, orientation == 1, cells);
+                cells |= occupied;
+                enumerateLayouts(masks, fleet, constraints, ship + 1, key, cells, layouts);
+            });
+        }
+    }
+    
+    // частоты клеток под кораблями по точному списку расстановок
+    std::vector<double> cellFrequencies(const std::vector<uint64_t>& layouts, int cells) {
+        std::vector<double> frequencies(cells, 0.0);
+        for (uint64_t layout : layouts) {
+            for (uint64_t bits = layout; bits; bits &= bits - 1) {
+                frequencies[__builtin_ctzll(bits)]++;
+            }
+        }
+        for (double& frequency : frequencies) frequency /= layouts.size();
+        return frequencies;
+    }
+    
+    // нормированное отклонение хи-квадрат: (x - df) / sqrt(2 df), |z| < 3 - согласие
+    double chiSquareZ(double chiSquare, long long degrees) {
+        return degrees > 0 ? (chiSquare - degrees) / std::sqrt(2.0 * degrees) : 0.0;
+    }
+    
+    // частоты клеток под кораблями в count расстановках генератора; layoutHits - частоты
+    // самих расстановок по номеру в отсортированном layouts (если он не пуст)
+    double sampleLayouts(FleetGenerator& generator, long long count, uint64_t seed, 
+                         std::vector<long long>& cellHits, const std::vector<uint64_t>& layouts,
+                         std::vector<long long>& layoutHits) {
+        int size = generator.getSize();
+        Bitboard shipCells(size * size);
+        Rng rng(seed);
+        cellHits.assign(size * size, 0);
+        layoutHits.assign(layouts.size(), 0);
+        
+        auto start = std::chrono::steady_clock::now();
+        for (long long i = 0; i < count; i++) {
+            generator.generate(rng);
+            uint64_t layout = 0;  // маска палуб, на поле до 8x8 - вся расстановка
+            for (const Placement& placement : generator.getLayout()) {
+                generator.getMasks().shipMask(placement.y * size + placement.x, placement.size, 
+                                              placement.vertical, shipCells);
+                shipCells.forEachSetBit([&](int cell) { cellHits[cell]++; });
+                layout |= shipCells.getWord(0);
+            }
+            if (!layouts.empty()) {
+                layoutHits[std::lower_bound(layouts.begin(), layouts.end(), layout) - layouts.begin()]++;
+            }
+        }
+        auto finish = std::chrono::steady_clock::now();
+        return std::chrono::duration<double>(finish - start).count();
+    }
+    
+    // равномерность генератора расстановок в зависимости от числа проходов Гиббса
+    // на поле до 8x8 частоты клеток и расстановок сравниваются с точными (полный перебор),
+    // на большом поле - частоты клеток с цепочкой в REFERENCE_SWEEPS проходов
+    void checkLayoutUniformity(long long count, const BoardConfig& config, uint64_t seed) {
+        const int sweepCounts[] = {0, 1, 2, 3, 4, 6, 8};
+        const int REFERENCE_SWEEPS = 64;
+        
+        int cells = config.size * config.size;
+        FleetGenerator generator(config.size, config.fleet);
+        std::vector<double> reference(cells, 0.0);
+        std::vector<uint64_t> layouts;
+        std::vector<long long> cellHits;
+        std::vector<long long> layoutHits;
+        bool exact = config.size <= 8;
+        
+        if (exact) {
+            LayoutConstraints constraints = {generator.getMasks().getFullBoard().getWord(0), 0};
+            enumerateLayouts(generator.getMasks(), generator.getFleet(), constraints, 0, -1, Bitboard(cells), layouts);
+            if (layouts.empty()) {
+                std::cout << "Флот не помещается на поле\n";
+                return;
+            }
+            std::sort(layouts.begin(), layouts.end());
+            reference = cellFrequencies(layouts, cells);
+            std::cout << "Поле " << config.size << "x" << config.size << ", расстановок всего: " 
+                      << layouts.size() << ", выборок: " << count << "\n";
+        } else {
+            generator.setSweeps(REFERENCE_SWEEPS);
+            sampleLayouts(generator, count, seed ^ 0x9E3779B97F4A7C15ULL, cellHits, layouts, layoutHits);
+            for (int cell = 0; cell < cells; cell++) {
+                reference[cell] = static_cast<double>(cellHits[cell]) / count;
+            }
+            std::cout << "Поле " << config.size << "x" << config.size << ", образец - " << REFERENCE_SWEEPS 
+                      << " проходов, выборок: " << count << "\n";
+        }
+        
+        // расстановки сравниваются, только если на каждую приходится хотя бы 5 выборок
+        bool compareLayouts = exact && count >= 5 * static_cast<long long>(layouts.size());
+        if (!compareLayouts) layouts.clear();
+        
+        std::cout << "Проходов   откл. клетки, %   z клетки   z расстановок   нс/расстановку\n";
+        for (int sweeps : sweepCounts) {
+            generator.setSweeps(sweeps);
+            double seconds = sampleLayouts(generator, count, seed, cellHits, layouts, layoutHits);
+            
+            // у образца цепочки своя дисперсия - она удваивает дисперсию разности
+            double varianceScale = exact ? 1.0 : 2.0;
+            double worstDeviation = 0.0, worstZ = 0.0;
+            for (int cell = 0; cell < cells; cell++) {
+                double p = reference[cell];
+                if (p <= 0.0 || p >= 1.0) continue;
+                double deviation = static_cast<double>(cellHits[cell]) / count - p;
+                worstDeviation = std::max(worstDeviation, std::abs(deviation));
+                worstZ = std::max(worstZ, std::abs(deviation) / std::sqrt(varianceScale * p * (1.0 - p) / count));
+            }
+            
+            std::cout << std::setw(8) << sweeps << std::setw(18) << 100.0 * worstDeviation 
+                      << std::setw(11) << worstZ;
+            if (compareLayouts) {
+                double expected = static_cast<double>(count) / layouts.size();
+                double chiSquare = 0.0;
+                for (long long hits : layoutHits) {
+                    chiSquare += (hits - expected) * (hits - expected) / expected;
+                }
+                std::cout << std::setw(16) << chiSquareZ(chiSquare, static_cast<long long>(layouts.size()) - 1);
+            } else {
+                std::cout << std::setw(16) << "-";
+            }
+            std::cout << std::setw(17) << (count > 0 ? seconds * 1e9 / count : 0.0) << "\n";
+        }
+    }
+    
+    // запись результата выстрела в наблюдение
+    void recordResult(Observation& observation, int x, int y, Field::AttackResult result) {
+        switch (result) {
+            case Field::AttackResult::Miss:
+                observation.recordMiss(x, y);
+                break;
+            case Field::AttackResult::Hit:
+                observation.recordHit(x, y);
+                break;
+            case Field::AttackResult::Destroyed:
+                observation.recordDestroyed(x, y);
+                break;
+            default:
+                break;
+        }
+    }
+    
+    // равномерность PosteriorSampler на поле до 8x8: наблюдение - выстрелы по случайной расстановке
+    // до попадания по живому кораблю; расстановки после reset и steps шагов цепи (каждая выборка - 
+    // из своего reset) и подряд идущие шаги одной цепи сравниваются с полным перебором согласованных;
+    // у шагов цепи ошибка частоты клетки оценивается по средним BATCHES отрезков цепи;
+    // строка "уточн." - цепь по наблюдению без последнего промаха, продолженная reset по полному
+    void checkPosteriorUniformity(long long count, const BoardConfig& config, uint64_t seed) {
+        const int stepCounts[] = {0, 8, 32};
+        const int BATCHES = 20;
+        
+        int cells = config.size * config.size;
+        Rng rng(seed);
+        Field field(config);
+        field.setRng(&rng);
+        if (!field.placeAllShipsAuto()) return;
+        
+        std::vector<int> order(cells);
+        for (int cell = 0; cell < cells; cell++) order[cell] = cell;
+        std::shuffle(order.begin(), order.end(), rng);
+        
+        Observation observation(config.size, config.fleet);
+        std::vector<std::pair<int, Field::AttackResult>> results;
+        int shots = 0;
+        for (int cell : order) {
+            if (observation.getHits().any() && shots >= config.size) break;
+            Field::AttackResult result = field.attack(cell % config.size, cell / config.size);
+            recordResult(observation, cell % config.size, cell / config.size, result);
+            results.push_back({cell, result});
+            shots++;
+        }
+        
+        // то же без последнего промаха
+        Observation coarse(config.size, config.fleet);
+        int lastMiss = -1;
+        for (size_t i = 0; i < results.size(); i++) {
+            if (results[i].second == Field::AttackResult::Miss) lastMiss = static_cast<int>(i);
+        }
+        for (size_t i = 0; i < results.size(); i++) {
+            if (static_cast<int>(i) == lastMiss) continue;
+            recordResult(coarse, results[i].first % config.size, results[i].first / config.size, results[i].second);
+        }
+        
+        PosteriorSampler sampler(config.size);
+        PlacementMasks masks(config.size);
+        std::vector<int> fleet = observation.getRemainingShips();
+        std::sort(fleet.begin(), fleet.end(), std::greater<int>());
+        for (int length : fleet) masks.ensureLength(length);
+        
+        Bitboard sunkHalo = masks.dilate(observation.getSunk());
+        LayoutConstraints constraints = {
+            masks.getFullBoard().getWord(0) & ~observation.getMisses().getWord(0) & ~sunkHalo.getWord(0),
+            observation.getHits().getWord(0)
+        };
+        std::vector<uint64_t> layouts;
+        enumerateLayouts(masks, fleet, constraints, 0, -1, Bitboard(cells), layouts);
+        std::sort(layouts.begin(), layouts.end());
+        if (layouts.empty()) return;
+        std::vector<double> reference = cellFrequencies(layouts, cells);
+        
+        std::cout << "\nВыборка по наблюдению: выстрелов " << shots << ", попаданий " 
+                  << observation.getHits().count() << ", кораблей осталось " << fleet.size()
+                  << ", согласованных расстановок " << layouts.size() << "\n";
+        std::cout << "Шагов      откл. клетки, %   z клетки   z расстановок   мкс/выборку\n";
+        
+        std::vector<long long> layoutHits(layouts.size());
+        std::vector<long long> cellHits(cells);
+        std::vector<long long> batchHits(cells * BATCHES);
+        // batched - выборки подряд из одной цепи: они зависимы, поэтому ошибку частоты даёт
+        // разброс средних по отрезкам, а z расстановок (он предполагает независимость) не считается
+        auto report = [&](const std::string& label, long long samples, double seconds, bool batched) {
+            long long batchSize = samples / BATCHES;
+            double worstDeviation = 0.0, worstZ = 0.0;
+            double correlation = 0.0;  // сумма по клеткам (ошибка по отрезкам / ошибка независимых)^2
+            int variableCells = 0;
+            for (int cell = 0; cell < cells; cell++) {
+                double p = reference[cell];
+                if (p <= 0.0 || p >= 1.0) continue;
+                double deviation = static_cast<double>(cellHits[cell]) / samples - p;
+                double error = std::sqrt(p * (1.0 - p) / samples);
+                if (batched) {
+                    double variance = 0.0;
+                    for (int batch = 0; batch < BATCHES; batch++) {
+                        double batchDeviation = static_cast<double>(batchHits[cell * BATCHES + batch]) / batchSize - 
+                                                static_cast<double>(cellHits[cell]) / samples;
+                        variance += batchDeviation * batchDeviation;
+                    }
+                    double independentError = error;
+                    error = std::sqrt(variance / (BATCHES - 1) / BATCHES);
+                    correlation += (error / independentError) * (error / independentError);
+                    variableCells++;
+                }
+                worstDeviation = std::max(worstDeviation, std::abs(deviation));
+                if (error > 0.0) worstZ = std::max(worstZ, std::abs(deviation) / error);
+            }
+            double expected = static_cast<double>(samples) / layouts.size();
+            double chiSquare = 0.0;
+            for (long long hits : layoutHits) {
+                chiSquare += (hits - expected) * (hits - expected) / expected;
+            }
+            
+            std::cout << std::setw(8) << label << std::setw(18) << 100.0 * worstDeviation << std::setw(11) << worstZ;
+            if (!batched && expected >= 5.0) {
+                std::cout << std::setw(16) << chiSquareZ(chiSquare, static_cast<long long>(layouts.size()) - 1);
+            } else {
+                std::cout << std::setw(16) << "-";
+            }
+            std::cout << std::setw(14) << (samples > 0 ? seconds * 1e6 / samples : 0.0) << "\n";
+            if (batched && variableCells > 0) {
+                // во столько раз меньше независимых выборок, чем шагов цепи
+                std::cout << "Время корреляции цепи, шагов: " << correlation / variableCells << "\n";
+            }
+        };
+        auto tally = [&]() {
+            uint64_t layout = sampler.getOccupied().getWord(0);
+            layoutHits[std::lower_bound(layouts.begin(), layouts.end(), layout) - layouts.begin()]++;
+            for (uint64_t bits = layout; bits; bits &= bits - 1) {
+                cellHits[__builtin_ctzll(bits)]++;
+            }
+        };
+        
+        for (int steps : stepCounts) {
+            std::fill(layoutHits.begin(), layoutHits.end(), 0);
+            std::fill(cellHits.begin(), cellHits.end(), 0);
+            auto start = std::chrono::steady_clock::now();
+            for (long long i = 0; i < count; i++) {
+                // каждая выборка - с поиска, а не продолжение прошлой цепи
+                sampler.discardChain();
+                if (!sampler.reset(observation, rng)) return;
+                for (int step = 0; step < steps; step++) sampler.step(rng);
+                tally();
+            }
+            auto finish = std::chrono::steady_clock::now();
+            report(std::to_string(steps), count, std::chrono::duration<double>(finish - start).count(), false);
+        }
+        
+        // продолжение цепи: засчитываются только reset, которые продолжили её
+        if (lastMiss >= 0) {
+            std::fill(layoutHits.begin(), layoutHits.end(), 0);
+            std::fill(cellHits.begin(), cellHits.end(), 0);
+            long long continued = 0;
+            auto start = std::chrono::steady_clock::now();
+            for (long long i = 0; i < count * 20 && continued < count; i++) {
+                if (!sampler.reset(coarse, rng)) return;
+                for (int step = 0; step < 8; step++) sampler.step(rng);
+                if (!sampler.reset(observation, rng)) return;
+                if (!sampler.isContinued()) continue;
+                tally();
+                continued++;
+            }
+            auto finish = std::chrono::steady_clock::now();
+            if (continued > 0) report("уточн.", continued, std::chrono::duration<double>(finish - start).count(), false);
+        }
+        
+        // цепь: count шагов подряд после одного reset, остаток от деления на отрезки отбрасывается
+        long long chainSamples = count / BATCHES * BATCHES;
+        std::fill(layoutHits.begin(), layoutHits.end(), 0);
+        std::fill(cellHits.begin(), cellHits.end(), 0);
+        std::fill(batchHits.begin(), batchHits.end(), 0);
+        sampler.discardChain();
+        if (chainSamples == 0 || !sampler.reset(observation, rng)) return;
+        auto start = std::chrono::steady_clock::now();
+        for (long long i = 0; i < chainSamples; i++) {
+            sampler.step(rng);
+            tally();
+            int batch = static_cast<int>(i / (chainSamples / BATCHES));
+            sampler.getOccupied().forEachSetBit([&](int cell) { batchHits[cell * BATCHES + batch]++; });
+        }
+        auto finish = std::chrono::steady_clock::now();
+        report("цепь", chainSamples, std::chrono::duration<double>(finish - start).count(), true);
+    }
+    
+    // наблюдение после shots случайных выстрелов по полю field
+    Observation observeRandomShots(Field& field, int shots) {
+        Observation observation(field.getSize(), FleetGenerator::standardFleet());
+        Rng& rng = threadRng();
+        for (int i = 0; i < shots; i++) {
+            int x = rng.below(field.getSize());
+            int y = rng.below(field.getSize());
+            recordResult(observation, x, y, field.attack(x, y));
+        }
+        return observation;
+    }
+    
+    void benchmarkPosterior(long long positions) {
+        const int SHOTS = 40;
+        const int SAMPLES = 2000;
+        // после выборки - ещё выстрелы по одному по неизвестным клеткам, как в партии
+        const int FOLLOW_SHOTS = 10;
+        const int FOLLOW_SAMPLES = 200;
+        
+        Field field;
+        PosteriorSampler sampler(field.getSize());
+        std::vector<int> counts;
+        long long sampled = 0, shipUpdates = 0, failed = 0;
+        double resetSeconds = 0.0, sampleSeconds = 0.0, acceptance = 0.0;
+        double shipProbability = 0.0, emptyProbability = 0.0;
+        long long shipCells = 0, emptyCells = 0;
+        long long followResets = 0, keptChains = 0;
+        double followSeconds = 0.0;
+        
+        for (long long i = 0; i < positions; i++) {
+            field.reset();
+            field.placeAllShipsAuto();
+            Observation observation = observeRandomShots(field, SHOTS);
+            
+            auto start = std::chrono::steady_clock::now();
+            bool ready = sampler.reset(observation, threadRng());
+            auto sampledFrom = std::chrono::steady_clock::now();
+            if (!ready) {
+                failed++;
+                continue;
+            }
+            counts.assign(field.getSize() * field.getSize(), 0);
+            sampler.accumulate(SAMPLES, threadRng(), counts);
+            auto finish = std::chrono::steady_clock::now();
+            
+            resetSeconds += std::chrono::duration<double>(sampledFrom - start).count();
+            sampleSeconds += std::chrono::duration<double>(finish - sampledFrom).count();
+            sampled += SAMPLES;
+            shipUpdates += static_cast<long long>(SAMPLES) * sampler.getFleet().size();
+            acceptance += sampler.getPairAcceptance();
+            
+            // согласованность с истинной расстановкой на неизвестных клетках
+            for (int y = 0; y < field.getSize(); y++) {
+                for (int x = 0; x < field.getSize(); x++) {
+                    if (observation.isKnown(x, y)) continue;
+                    double probability = static_cast<double>(counts[y * field.getSize() + x]) / SAMPLES;
+                    if (field.getCellState(x, y) == CellState::Ship) {
+                        shipProbability += probability;
+                        shipCells++;
+                    } else {
+                        emptyProbability += probability;
+                        emptyCells++;
+                    }
+                }
+            }
+            
+            Rng& rng = threadRng();
+            for (int shot = 0; shot < FOLLOW_SHOTS && !observation.getRemainingShips().empty(); shot++) {
+                int x, y;
+                do {
+                    x = rng.below(field.getSize());
+                    y = rng.below(field.getSize());
+                } while (observation.isKnown(x, y));
+                recordResult(observation, x, y, field.attack(x, y));
+                
+                auto followStart = std::chrono::steady_clock::now();
+                ready = sampler.reset(observation, rng);
+                followSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - followStart).count();
+                if (!ready) break;
+                if (sampler.isContinued()) keptChains++;
+                followResets++;
+                sampler.accumulate(FOLLOW_SAMPLES, rng, counts);
+            }
+        }
+        
+        long long solved = positions - failed;
+        double sampleMs = sampleSeconds * 1000.0;
+        std::cout << "Позиций:                   " << positions << " (выстрелов: " << SHOTS << ")\n";
+        std::cout << "Без расстановки:           " << failed << "\n";
+        std::cout << "Поиск начальной, мкс:      " << (solved > 0 ? resetSeconds * 1e6 / solved : 0.0) << "\n";
+        std::cout << "reset после выстрела, мкс: " << (followResets > 0 ? followSeconds * 1e6 / followResets : 0.0) 
+                  << " (цепь продолжена: " << (followResets > 0 ? 100.0 * keptChains / followResets : 0.0) << "%)\n";
+        std::cout << "Выборок в мс:              " << (sampleMs > 0.0 ? sampled / sampleMs : 0.0) << "\n";
+        std::cout << "Перестановок кораблей в мс: " << (sampleMs > 0.0 ? shipUpdates / sampleMs : 0.0) << "\n";
+        std::cout << "Приём парных ходов:        " << (solved > 0 ? acceptance / solved : 0.0) << "\n";
+        std::cout << "Вероятность на кораблях:   " << (shipCells > 0 ? shipProbability / shipCells : 0.0) << "\n";
+        std::cout << "Вероятность на пустых:     " << (emptyCells > 0 ? emptyProbability / emptyCells : 0.0) << "\n";
+    }
+    
+    void benchmarkMoves(long long movesPerSize) {
+        const int sizes[] = {10, 20, 40, 80, 160, 320};
+        
+        std::cout << "Поле     Ходов       нс/ход\n";
+        for (int size : sizes) {
+            BoardConfig config(size, FleetGenerator::standardFleet());
+            ComputerPlayer computer("Компьютер", TargetingStrategy::HuntTarget, config);
+            Field target(config);
+            long long moves = 0;
+            double seconds = 0.0;
+            
+            // каждый прогон обстреливает поле целиком; подготовка поля не замеряется
+            while (moves < movesPerSize) {
+                computer.reset();
+                target.reset();
+                target.placeAllShipsAuto();
+                
+                int cells = size * size;
+                auto start = std::chrono::steady_clock::now();
+                for (int i = 0; i < cells; i++) {
+                    std::pair<int, int> shot = computer.makeMove();
+                    computer.onAttackResult(shot.first, shot.second, target.attack(shot.first, shot.second));
+                }
+                auto finish = std::chrono::steady_clock::now();
+                
+                seconds += std::chrono::duration<double>(finish - start).count();
+                moves += cells;
+            }
+            
+            std::cout << size << "x" << size << "\t " << moves << "\t     " 
+                      << (moves > 0 ? seconds * 1e9 / moves : 0.0) << "\n";
+        }
+    }
+    
+    // чтение файла партий: скорость разбора и сводка по записанным партиям
+    bool readRecords(const std::string& path) {
+        GameRecordReader reader;
+        if (!reader.open(path)) {
+            std::cerr << "Не удалось открыть файл партий: " << path << "\n";
+            return false;
+        }
+        
+        GameRecord record;
+        long long games = 0;
+        long long shots = 0;
+        long long player1Wins = 0;
+        auto start = std::chrono::steady_clock::now();
+        while (reader.next(record)) {
+            games++;
+            shots += record.shots.size();
+            player1Wins += record.winner == 1;
+        }
+        auto finish = std::chrono::steady_clock::now();
+        
+        double seconds = std::chrono::duration<double>(finish - start).count();
+        double megabytes = reader.getFileSize() / (1024.0 * 1024.0);
+        std::cout << "Поле:                  " << reader.getConfig().size << "x" << reader.getConfig().size << "\n";
+        std::cout << "Партий прочитано:      " << games << "\n";
+        std::cout << "Размер файла, МБ:      " << megabytes << "\n";
+        std::cout << "Байт на партию:        " << (games > 0 ? reader.getFileSize() / static_cast<double>(games) : 0.0) << "\n";
+        std::cout << "Выстрелов в партии:    " << (games > 0 ? static_cast<double>(shots) / games : 0.0) << "\n";
+        std::cout << "Побед игрока 1:        " << (games > 0 ? 100.0 * player1Wins / games : 0.0) << "%\n";
+        std::cout << "Время, с:              " << seconds << "\n";
+        std::cout << "Партий в секунду:      " << (seconds > 0.0 ? games / seconds : 0.0) << "\n";
+        std::cout << "МБ в секунду:          " << (seconds > 0.0 ? megabytes / seconds : 0.0) << "\n";
+        if (reader.failed()) {
+            std::cerr << "Файл партий оборван или испорчен после партии " << games << "\n";
+            return false;
+        }
+        return true;
+    }
+    
+    bool renderThumbnails(const std::string& path, int threads, const ThumbnailBatch::Options& options) {
+        ThumbnailBatch batch(threads);
+        ThumbnailBatch::Stats stats;
+        if (!batch.render(path, options, stats)) {
+            std::cerr << "Не удалось открыть файл партий " << path << " или создать каталог " 
+                      << options.outputDirectory << "\n";
+            return false;
+        }
+        
+        std::cout << "Потоков:               " << batch.getThreadCount() << "\n";
+        std::cout << "Миниатюр:              " << stats.images << "\n";
+        std::cout << "Ошибок:                " << stats.failed << "\n";
+        std::cout << "Записано, МБ:          " << stats.bytes / (1024.0 * 1024.0) << "\n";
+        std::cout << "Время, с:              " << stats.seconds << "\n";
+        std::cout << "Миниатюр в секунду:    " << (stats.seconds > 0.0 ? stats.images / stats.seconds : 0.0) << "\n";
+        return true;
+    }
+    
+    // огромные поля хранятся разреженно: память растёт с числом выстрелов, а не с площадью
+    void benchmarkLarge(long long shots, const std::vector<int>& fleet) {
+        const int sizes[] = {1000, 4000, 16000, 46000};
+        
+        std::cout << "Поле          Выстрелов   Память поля, КБ   Память после, КБ   нс/выстрел\n";
+        for (int size : sizes) {
+            BoardConfig config(size, fleet);
+            if (!config.isValid()) continue;
+            
+            ComputerPlayer computer("Компьютер", TargetingStrategy::HuntTarget, config);
+            Field target(config);
+            target.placeAllShipsAuto();
+            size_t before = target.memoryUsage();
+            
+            long long fired = 0;
+            auto start = std::chrono::steady_clock::now();
+            while (fired < shots && !target.allShipsDestroyed()) {
+                std::pair<int, int> shot = computer.makeMove();
+                computer.onAttackResult(shot.first, shot.second, target.attack(shot.first, shot.second));
+                fired++;
+            }
+            auto finish = std::chrono::steady_clock::now();
+            
+            double seconds = std::chrono::duration<double>(finish - start).count();
+            std::cout << size << "x" << size << "\t" << std::setw(12) << fired 
+                      << std::setw(18) << before / 1024 
+                      << std::setw(19) << target.memoryUsage() / 1024 
+                      << std::setw(13) << (fired > 0 ? seconds * 1e9 / fired : 0.0) << "\n";
+        }
+    }
+}
+
+int main(int argc, char* argv[]) {
+    std::string mode = "single";
+    int argIndex = 1;
+    if (argc > 1) {
+        std::string first = argv[1];
+        if (first == "tournament" || first == "layouts" || first == "uniformity" || first == "posterior" || 
+            first == "moves" || first == "large" || first == "replay" || first == "records" || 
+            first == "thumbnails") {
+            mode = first;
+            argIndex = 2;
+        }
+    }
+    
+    long long games = 100000;
+    int threads = 0;
+    TargetingStrategy player1Strategy = TargetingStrategy::HuntTarget;
+    TargetingStrategy player2Strategy = TargetingStrategy::HuntTarget;
+    BoardConfig config;
+    bool configGiven = false;
+    int tableMegabytes = 0;
+    uint64_t seed = 12345;
+    bool seedGiven = false;
+    std::string recordPath;
+    bool gamesGiven = false;
+    ThumbnailBatch::Options thumbnailOptions;
+    
+    try {
+        if (argc > argIndex && argv[argIndex][0] != '-') {
+            games = std::stoll(argv[argIndex++]);
+            gamesGiven = true;
+        }
+        for (int i = argIndex; i < argc; i++) {
+            std::string arg = argv[i];
+            if (i + 1 >= argc) throw std::invalid_argument(arg);
+            std::string value = argv[++i];
+            
+            if (arg == "--threads") {
+                threads = std::stoi(value);
+            } else if (arg == "--p1") {
+                if (!parseStrategy(value, player1Strategy)) throw std::invalid_argument(value);
+            } else if (arg == "--p2") {
+                if (!parseStrategy(value, player2Strategy)) throw std::invalid_argument(value);
+            } else if (arg == "--size") {
+                config.size = std::stoi(value);
+                configGiven = true;
+            } else if (arg == "--fleet") {
+                if (!BoardConfig::parseFleet(value, config.fleet)) throw std::invalid_argument(value);
+                configGiven = true;
+            } else if (arg == "--seed") {
+                seed = std::stoull(value);
+                seedGiven = true;
+            } else if (arg == "--record") {
+                recordPath = value;
+            } else if (arg == "--tt") {
+                tableMegabytes = std::stoi(value);
+                if (tableMegabytes < 0) throw std::invalid_argument(value);
+            } else if (arg == "--out") {
+                thumbnailOptions.outputDirectory = value;
+            } else if (arg == "--cell") {
+                thumbnailOptions.cellPixels = std::stoi(value);
+                if (thumbnailOptions.cellPixels < 1) throw std::invalid_argument(value);
+            } else if (arg == "--format") {
+                if (value == "png") thumbnailOptions.format = ThumbnailBatch::Format::Png;
+                else if (value == "ppm") thumbnailOptions.format = ThumbnailBatch::Format::Ppm;
+                else throw std::invalid_argument(value);
+            } else if (arg == "--position") {
+                thumbnailOptions.position = std::stoi(value);
+            } else {
+                throw std::invalid_argument(arg);
+            }
+        }
+        if (mode == "uniformity") {
+            // по умолчанию - поле, на котором расстановки можно перебрать все
+            if (!configGiven) config = BoardConfig(5, {3, 2, 1, 1});
+            if (!gamesGiven) games = 1000000;
+        }
+        if (!config.isValid()) throw std::invalid_argument("config");
+        // файл партий пишет только обычная симуляция, records и thumbnails его читают
+        if (!recordPath.empty() && mode != "single" && mode != "records" && mode != "thumbnails") {
+            throw std::invalid_argument("--record");
+        }
+    } catch (...) {
+        printUsage(argv[0]);
+        return 1;
+    }
+    
+    std::unique_ptr<TranspositionTable> table;
+    if (tableMegabytes > 0) {
+        table = std::make_unique<TranspositionTable>(tableMegabytes);
+    }
+    
+    if (mode == "layouts") {
+        benchmarkLayouts(games, config);
+    } else if (mode == "uniformity") {
+        checkLayoutUniformity(games, config, seed);
+        if (config.size <= 8) checkPosteriorUniformity(games / 20, config, seed);
+    } else if (mode == "moves") {
+        benchmarkMoves(games);
+    } else if (mode == "posterior") {
+        benchmarkPosterior(games);
+    } else if (mode == "large") {
+        benchmarkLarge(games, config.fleet);
+    } else if (mode == "records") {
+        if (recordPath.empty()) {
+            printUsage(argv[0]);
+            return 1;
+        }
+        if (!readRecords(recordPath)) return 1;
+    } else if (mode == "thumbnails") {
+        if (recordPath.empty() || thumbnailOptions.outputDirectory.empty()) {
+            printUsage(argv[0]);
+            return 1;
+        }
+        thumbnailOptions.limit = gamesGiven ? games : -1;
+        if (!renderThumbnails(recordPath, threads, thumbnailOptions)) return 1;
+    } else if (mode == "replay") {
+        Game game(player1Strategy, player2Strategy, config);
+        game.setTranspositionTable(table.get());
+        GameResult result = game.runHeadless(seed);
+        std::cout << "Зерно партии:       " << result.seed << "\n"
+                  << "Победитель:         компьютер " << result.winner << "\n"
+                  << "Ходов:              " << result.turns << "\n"
+                  << "Выстрелов 1 / 2:    " << result.player1Shots << " / " << result.player2Shots << "\n";
+    } else if (mode == "tournament") {
+        Tournament tournament(threads, player1Strategy, player2Strategy, config);
+        tournament.setTranspositionTable(table.get());
+        std::cout << "Потоков: " << tournament.getThreadCount() << "\n";
+        printReport(std::cout, tournament.play(games, seed));
+        std::cout << "\n";
+        tournament.printScalingReport(std::cout, games, seed);
+    } else {
+        if (seedGiven) seedThreadRng(seed);
+        HeadlessSimulator simulator(player1Strategy, player2Strategy, config);
+        simulator.setTranspositionTable(table.get());
+        
+        std::unique_ptr<GameRecordWriter> writer;
+        if (!recordPath.empty()) {
+            writer = std::make_unique<GameRecordWriter>(recordPath, config);
+            if (!writer->isOpen()) {
+                std::cerr << "Не удалось создать файл партий: " << recordPath << "\n";
+                return 1;
+            }
+            simulator.setRecordWriter(writer.get());
+        }
+        printReport(std::cout, simulator.run(games));
+        
+        if (writer) {
+            if (!writer->flush()) {
+                std::cerr << "Ошибка записи файла партий: " << recordPath << "\n";
+                return 1;
+            }
+            std::cout << "Записано партий:       " << writer->getRecordCount() 
+                      << " (" << writer->getBytesWritten() << " байт)\n";
+        }
+    }
+    return 0;
+}